@@ -0,0 +1,102 @@
+// Times the per-actor progression cache on the NPC cast path as the number of actors casting grows.
+//
+//   ShoutProgressionActorBench [ops]
+//
+// Each round models a battle: `actors` distinct actors cast in random order, and every cast looks up its actor's
+// progression, resolving it on a miss as ShoutHandler does. Battles larger than the cache thrash it on purpose, to show
+// what eviction costs. The threaded round runs the same battle on every core at once against one shared cache. Exits
+// with 1 when a lookup allocates.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "core/ActorCache.h"
+
+namespace {
+    constexpr std::size_t CACHE_SIZE = 512;  // ShoutHandler::ACTOR_CACHE_SIZE
+
+    std::vector<std::uint32_t> MakeActors(std::size_t count, std::uint32_t seed) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ seed;
+        std::vector<std::uint32_t> actors(count);
+        for (auto& formID : actors) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            // Placed references of the first few plugins and references created at runtime (FF......)
+            formID = (state & 3) == 0 ? 0xFF000000u | static_cast<std::uint32_t>(state >> 40 & 0xFFFFFF)
+                                      : static_cast<std::uint32_t>((state >> 8) % 0x06000000u) + 1;
+        }
+        return actors;
+    }
+
+    Core::ActorProgression Resolve(std::uint32_t formID) {
+        using Source = Core::ActorProgression::Source;
+        switch (formID % 8) {
+            case 0:
+                return { Source::kFixed, static_cast<std::uint16_t>(formID % 51) };
+            case 1:
+                return { Source::kFollower, 0 };
+            default:
+                return { Source::kNone, 0 };
+        }
+    }
+
+    Bench::Result Battle(Core::ActorCache& cache, const std::vector<std::uint32_t>& actors,
+                         const std::vector<std::uint32_t>& order, std::uint64_t ops, std::uint64_t offset) {
+        return Bench::Measure(ops, [&](std::uint64_t i) {
+            auto formID = actors[order[(i + offset) % order.size()]];
+            auto progression = cache.Get(formID, 1, [formID]() { return Resolve(formID); });
+            Bench::DoNotOptimize(progression);
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    std::uint64_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    if (ops == 0) {
+        std::fprintf(stderr, "usage: %s [ops]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    std::printf("Actor cache: %zu actors (%zu bytes), %u threads in the shared round\n\n",
+                Core::ActorCache(CACHE_SIZE).Capacity(), Core::ActorCache(CACHE_SIZE).GetMemoryFootprint(), threads);
+    std::printf("%8s %14s %10s %10s %14s\n", "actors", "lookup ns/op", "hit rate", "allocs/op", "shared ns/op");
+
+    bool steady = true;
+    for (std::size_t actorCount : { 4u, 32u, 256u, 512u, 4096u }) {
+        auto actors = MakeActors(actorCount, static_cast<std::uint32_t>(actorCount));
+        std::vector<std::uint32_t> order(4096);
+        for (std::size_t i = 0; i < order.size(); i++) {
+            order[i] = static_cast<std::uint32_t>((i * 2654435761u >> 7) % actorCount);
+        }
+
+        Core::ActorCache cache(CACHE_SIZE);
+        Battle(cache, actors, order, order.size(), 0);  // warm up
+        auto before = cache.GetStats();
+        auto single = Battle(cache, actors, order, ops, 0);
+        auto after = cache.GetStats();
+        auto lookups = static_cast<double>((after.hits + after.misses) - (before.hits + before.misses));
+        auto hitRate = static_cast<double>(after.hits - before.hits) / lookups;
+
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() { Battle(cache, actors, order, ops / threads, t * 97); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%8zu %14.2f %9.1f%% %10.2f %14.2f\n", actorCount, single.nsPerOp, hitRate * 100.0,
+                    single.allocationsPerOp, elapsed / static_cast<double>(ops / threads * threads));
+        steady &= Bench::ExpectNoAllocations("actor lookup", single);
+    }
+    return steady ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "core/MemoryAccounting.h"
+
+// Timing and allocation counting shared by the benchmarks. Allocations are counted by the global operator new
+// replacement in AllocationCounter.cpp, which every benchmark executable links.
+namespace Bench {
+    inline std::atomic<std::uint64_t> g_allocations{ 0 };
+
+    inline std::uint64_t Allocations() { return g_allocations.load(std::memory_order_relaxed); }
+
+    struct Result {
+        double nsPerOp;
+        double allocationsPerOp;
+    };
+
+    // Times `ops` calls of `op(i)`
+    template <class F>
+    Result Measure(std::uint64_t ops, F&& op) {
+        auto allocations = Allocations();
+        auto start = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < ops; i++) {
+            op(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        return { ns / static_cast<double>(ops),
+                 static_cast<double>(Allocations() - allocations) / static_cast<double>(ops) };
+    }
+
+    inline void Report(const char* name, const Result& result) {
+        std::printf("%-28s %10.1f ns/op %10.2f allocs/op\n", name, result.nsPerOp, result.allocationsPerOp);
+    }
+
+    // Steady-state paths must not allocate at all. Names the path and returns false when `result` did.
+    inline bool ExpectNoAllocations(const char* name, const Result& result) {
+        if (result.allocationsPerOp == 0.0) {
+            return true;
+        }
+        std::fprintf(stderr, "FAILED: %s allocated %.4f times per op\n", name, result.allocationsPerOp);
+        return false;
+    }
+
+    // What each subsystem's tracked containers hold, as the plugin logs it
+    inline void ReportMemory() {
+        std::printf("%-28s %14s %14s %12s\n", "memory", "live bytes", "peak bytes", "allocations");
+        for (std::size_t i = 0; i < static_cast<std::size_t>(Core::Subsystem::kCount); i++) {
+            auto usage = Core::MemoryAccounting::GetUsage(static_cast<Core::Subsystem>(i));
+            std::printf("  %-26s %14llu %14llu %12llu\n", Core::SUBSYSTEM_NAMES[i],
+                        static_cast<unsigned long long>(usage.bytes), static_cast<unsigned long long>(usage.peakBytes),
+                        static_cast<unsigned long long>(usage.allocations));
+        }
+    }
+
+    // Keeps a value alive without letting the compiler see what happens to it
+    template <class T>
+    inline void DoNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+}
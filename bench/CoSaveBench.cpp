@@ -0,0 +1,172 @@
+// Times writing the applied shout state to the co-save and reconciling the forms with it on load, as Serialization
+// does, against a synthetic load order.
+//
+//   ShoutProgressionCoSaveBench [shouts] [ops]
+//
+// For each count of scaled shouts, the session scales that many shouts and then:
+//   save         collects the scaled shouts into the record and copies it out, as the save callback does
+//   load (same)  reconciles with the record just written, which the forms already hold: nothing is written
+//   load (other) reconciles with a record from another character, who has half of these shouts at other soul counts
+//                and as many shouts this session has vanilla
+// After each load every shout's applied state is checked against the record. Exits with 1 when the state is wrong or
+// when save or an unchanged load allocates.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "DefaultCurves.h"
+#include "MockForms.h"
+#include "core/ShoutPlan.h"
+
+namespace {
+    using Plan = Core::Plan<Mock::Forms>;
+
+    constexpr std::uint32_t GENERATION = 1;
+
+    // Serialization::AppliedShout
+    struct AppliedShout {
+        std::uint32_t formID;
+        std::uint32_t souls;
+    };
+
+    struct Session {
+        Plan& plan;
+        const Bench::DefaultCurves& tables;
+        std::vector<AppliedShout> saved;
+        std::vector<std::byte> record;  // stands in for the co-save
+        std::vector<Plan::Target> targets;
+
+        void Save() {
+            saved.clear();
+            plan.ForEachApplied([this](Mock::TESShout* shout, std::uint64_t stamp) {
+                if (Core::IsNPCStamp(stamp)) {
+                    return;
+                }
+                saved.push_back({ shout->formID, static_cast<std::uint32_t>(Core::StampSouls(stamp)) });
+            });
+            record.resize(saved.size() * sizeof(AppliedShout));
+            std::memcpy(record.data(), saved.data(), record.size());
+        }
+
+        Plan::ReconcileStats Load(const std::vector<AppliedShout>& from) {
+            targets.clear();
+            for (const auto& applied : from) {
+                if (auto* shout = Mock::Forms::LookupShout(applied.formID)) {
+                    targets.push_back({ shout, static_cast<int>(applied.souls) });
+                }
+            }
+            return plan.Reconcile(std::span<Plan::Target>(targets), GENERATION,
+                                  [this](const Mock::TESShout*, int souls) { return tables.For(souls); });
+        }
+
+        // Every shout in `expected` holds its souls, every other one is vanilla
+        bool Matches(const std::vector<AppliedShout>& expected) const {
+            std::size_t applied = 0;
+            bool ok = true;
+            plan.ForEachApplied([&](Mock::TESShout* shout, std::uint64_t stamp) {
+                applied++;
+                bool found = false;
+                for (const auto& entry : expected) {
+                    if (entry.formID == shout->formID) {
+                        found = stamp == Core::MakeStamp(GENERATION, static_cast<int>(entry.souls));
+                        break;
+                    }
+                }
+                ok &= found;
+            });
+            return ok && applied == expected.size();
+        }
+    };
+
+    std::vector<AppliedShout> Scaled(const Mock::LoadOrder& loadOrder, std::size_t count, std::size_t offset,
+                                     std::uint32_t souls) {
+        std::vector<AppliedShout> shouts;
+        auto stride = loadOrder.all.size() / count;
+        for (std::size_t i = 0; i < count; i++) {
+            auto* shout = loadOrder.all[(offset + i * stride) % loadOrder.all.size()];
+            shouts.push_back({ shout->formID, souls + static_cast<std::uint32_t>(i % 3) });
+        }
+        return shouts;
+    }
+}
+
+int main(int argc, char** argv) {
+    Mock::LoadOrderSpec spec;
+    if (argc > 1) {
+        spec.shouts = static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    std::uint64_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+    if (spec.shouts < 2000 || ops == 0) {
+        std::fprintf(stderr, "usage: %s [shouts >= 2000] [ops]\n", argv[0]);
+        return 1;
+    }
+
+    Mock::LoadOrder loadOrder(spec);
+    Bench::DefaultCurves tables;
+    Plan plan;
+    plan.Build(loadOrder.all);
+
+    std::printf("Synthetic load order: %zu shouts\n\n", loadOrder.all.size());
+    std::printf("%8s %12s %16s %16s %14s\n", "scaled", "save us", "load (same) us", "load (other) us", "records");
+
+    bool ok = true;
+    for (std::size_t count : { 10u, 120u, 500u, 1000u }) {
+        Session session{ plan, tables, {}, {}, {} };
+
+        // This session's character, and another one sharing half of the shouts at other soul counts
+        auto mine = Scaled(loadOrder, count, 0, 20);
+        auto theirs = Scaled(loadOrder, count, 0, 35);
+        auto extra = Scaled(loadOrder, count / 2, 1, 35);
+        theirs.resize(count / 2);
+        theirs.insert(theirs.end(), extra.begin(), extra.end());
+
+        session.Load(mine);
+        session.Save();  // sizes the buffers
+        auto save = Bench::Measure(ops, [&](std::uint64_t) { session.Save(); });
+
+        Plan::ReconcileStats same{};
+        auto loadSame = Bench::Measure(ops, [&](std::uint64_t) { same = session.Load(session.saved); });
+        ok &= same.written == 0 && session.Matches(mine);
+
+        // Alternating between the two characters, so every load rewrites what differs
+        double otherNs = 0.0;
+        std::uint32_t written = 0;
+        for (std::uint64_t i = 0; i < ops; i++) {
+            const auto& record = i % 2 == 0 ? theirs : mine;
+            Plan::ReconcileStats stats{};
+            auto load = Bench::Measure(1, [&](std::uint64_t) { stats = session.Load(record); });
+            otherNs += load.nsPerOp;
+            written = stats.written;
+            ok &= session.Matches(record);
+        }
+
+        std::printf("%8zu %12.2f %16.2f %16.2f %14u\n", count, save.nsPerOp / 1000.0, loadSame.nsPerOp / 1000.0,
+                    otherNs / static_cast<double>(ops) / 1000.0, written);
+        ok &= Bench::ExpectNoAllocations("save", save);
+        ok &= Bench::ExpectNoAllocations("load (same)", loadSame);
+        session.Load({});
+    }
+
+    // A shout an NPC scaled with its own souls is not saved as the player's, and the load restores it
+    {
+        Session session{ plan, tables, {}, {}, {} };
+        auto mine = Scaled(loadOrder, 10, 0, 20);
+        session.Load(mine);
+        plan.Apply(loadOrder.all[1], tables.For(45), Core::MakeNPCStamp(GENERATION, 45));
+        session.Save();
+        bool npcSaved = session.saved.size() != mine.size();
+        session.Load(session.saved);
+        ok &= !npcSaved && session.Matches(mine);
+        std::printf("\nNPC-scaled shout saved: %s\n", npcSaved ? "yes" : "no");
+        session.Load({});
+    }
+
+    if (!ok) {
+        std::fprintf(stderr, "FAILED: reconciled state does not match the record\n");
+    }
+    return ok ? 0 : 1;
+}
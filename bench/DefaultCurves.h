@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Curves.h"
+#include "core/ShoutPlan.h"
+
+namespace Bench {
+    // The multiplier tables Config bakes from the default settings
+    struct DefaultCurves {
+        Curves::MultiplierTable distance;
+        Curves::MultiplierTable magnitude;
+        Curves::MultiplierTable cooldown;
+
+        DefaultCurves() {
+            Curves::Curve distanceCurve;
+            distanceCurve.base = 1.0f;
+            distanceCurve.rate = 0.04f;
+            distance.Bake(distanceCurve, 50);
+
+            Curves::Curve magnitudeCurve;
+            magnitudeCurve.base = 1.0f;
+            magnitudeCurve.rate = 0.03f;
+            magnitude.Bake(magnitudeCurve, 50);
+
+            Curves::Curve cooldownCurve;
+            cooldownCurve.base = 1.0f;
+            cooldownCurve.rate = -0.01f;
+            cooldownCurve.min = 0.2f;
+            cooldown.Bake(cooldownCurve, 50);
+        }
+
+        Core::Multipliers For(int souls) const {
+            return { distance.Lookup(souls), magnitude.Lookup(souls), cooldown.Lookup(souls) };
+        }
+    };
+}
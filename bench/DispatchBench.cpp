@@ -0,0 +1,234 @@
+// Compares how much of a heavy-combat action stream reaches plugin code with the two ways of detecting shouts:
+//
+//   action sink  the handler is registered on the SKSE action event source and receives every action of every actor
+//                (weapon swings, bow draws, spell casts, ...) through a virtual call under the source's lock
+//   voice hook   the handler sits on ActorMagicCaster::SpellCast, so it only runs when a spell is actually cast,
+//                and returns after a spell type check unless that spell is a voice power
+//
+//   ShoutProgressionDispatchBench [events]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+    // Mirrors SKSE::ActionEvent::Type
+    enum class ActionType : std::uint8_t {
+        kWeaponSwing,
+        kSpellCast,
+        kSpellFire,
+        kVoiceCast,
+        kVoiceFire,
+        kBowDraw,
+        kBowRelease,
+        kBeginDraw,
+        kEndDraw,
+        kBeginSheathe,
+        kEndSheathe
+    };
+
+    enum class SpellType : std::uint8_t {
+        kSpell,
+        kVoicePower
+    };
+
+    struct ActionEvent {
+        ActionType type;
+        std::uint32_t actor;
+        std::uint32_t sourceForm;
+    };
+
+    struct Counters {
+        std::uint64_t delivered = 0;  // calls into plugin code
+        std::uint64_t handled = 0;    // calls that reached the shout logic
+    };
+
+    Counters g_counters;
+
+    // Stand-in for ShoutHandler::OnShoutCast; kept out of line so neither path can fold it away.
+    [[gnu::noinline]] void OnShoutCast(std::uint32_t actor, std::uint32_t shout) {
+        g_counters.handled++;
+        asm volatile("" : : "r"(actor), "r"(shout) : "memory");
+    }
+
+    // --- action sink path -------------------------------------------------------------------------------------
+
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+        virtual int ProcessEvent(const ActionEvent* event) = 0;
+    };
+
+    class ActionSink final : public Sink {
+    public:
+        [[gnu::noinline]] int ProcessEvent(const ActionEvent* event) override {
+            g_counters.delivered++;
+            if (event->type != ActionType::kVoiceCast && event->type != ActionType::kVoiceFire) {
+                return 0;
+            }
+            OnShoutCast(event->actor, event->sourceForm);
+            return 0;
+        }
+    };
+
+    // BSTEventSource: every sink gets every event, with the sink list guarded by a spin lock
+    class EventSource {
+    public:
+        void AddSink(Sink* sink) { _sinks.push_back(sink); }
+
+        void SendEvent(const ActionEvent& event) {
+            while (_lock.test_and_set(std::memory_order_acquire)) {
+            }
+            for (auto* sink : _sinks) {
+                sink->ProcessEvent(&event);
+            }
+            _lock.clear(std::memory_order_release);
+        }
+
+    private:
+        std::vector<Sink*> _sinks;
+        std::atomic_flag _lock = ATOMIC_FLAG_INIT;
+    };
+
+    // --- voice hook path --------------------------------------------------------------------------------------
+
+    using SpellCastFn = void (*)(std::uint32_t actor, SpellType type, std::uint32_t spell);
+
+    [[gnu::noinline]] void OriginalSpellCast(std::uint32_t actor, SpellType type, std::uint32_t spell) {
+        asm volatile("" : : "r"(actor), "r"(type), "r"(spell) : "memory");
+    }
+
+    SpellCastFn g_originalSpellCast = OriginalSpellCast;
+
+    [[gnu::noinline]] void SpellCastThunk(std::uint32_t actor, SpellType type, std::uint32_t spell) {
+        g_counters.delivered++;
+        if (type == SpellType::kVoicePower) {
+            OnShoutCast(actor, spell);
+        }
+        g_originalSpellCast(actor, type, spell);
+    }
+
+    // The vtable slot, patched to the thunk
+    volatile SpellCastFn g_spellCastSlot = SpellCastThunk;
+
+    // --- synthetic stream -------------------------------------------------------------------------------------
+
+    std::vector<ActionEvent> GenerateHeavyCombat(std::size_t count) {
+        // Rough mix for a large modded battle: mostly melee and archery, a steady share of spells, and a few shouts
+        struct Weight {
+            ActionType type;
+            std::uint32_t weight;
+        };
+        constexpr Weight weights[] = {
+            { ActionType::kWeaponSwing, 380 }, { ActionType::kBowDraw, 60 },      { ActionType::kBowRelease, 60 },
+            { ActionType::kBeginDraw, 25 },    { ActionType::kEndDraw, 25 },      { ActionType::kBeginSheathe, 10 },
+            { ActionType::kEndSheathe, 10 },   { ActionType::kSpellCast, 180 },   { ActionType::kSpellFire, 180 },
+            { ActionType::kVoiceCast, 35 },    { ActionType::kVoiceFire, 35 },
+        };
+        std::uint32_t total = 0;
+        for (const auto& weight : weights) {
+            total += weight.weight;
+        }
+
+        std::vector<ActionEvent> events;
+        events.reserve(count);
+        std::uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (std::size_t i = 0; i < count; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            auto roll = static_cast<std::uint32_t>(state % total);
+            auto type = weights[0].type;
+            for (const auto& weight : weights) {
+                if (roll < weight.weight) {
+                    type = weight.type;
+                    break;
+                }
+                roll -= weight.weight;
+            }
+            events.push_back({ type, 0xFF000000u + static_cast<std::uint32_t>((state >> 32) % 200),
+                               0x00013E07u + static_cast<std::uint32_t>((state >> 40) % 40) });
+        }
+        return events;
+    }
+
+    struct Result {
+        double seconds;
+        Counters counters;
+    };
+
+    Result RunActionSink(const std::vector<ActionEvent>& events) {
+        EventSource source;
+        ActionSink sink;
+        source.AddSink(&sink);
+
+        g_counters = {};
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& event : events) {
+            source.SendEvent(event);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return { std::chrono::duration<double>(elapsed).count(), g_counters };
+    }
+
+    Result RunVoiceHook(const std::vector<ActionEvent>& events) {
+        // The action source still exists in the game; it just has no sink of ours on it
+        EventSource source;
+
+        g_counters = {};
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& event : events) {
+            source.SendEvent(event);
+            if (event.type == ActionType::kSpellFire) {
+                g_spellCastSlot(event.actor, SpellType::kSpell, event.sourceForm);
+            } else if (event.type == ActionType::kVoiceFire) {
+                g_spellCastSlot(event.actor, SpellType::kVoicePower, event.sourceForm);
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return { std::chrono::duration<double>(elapsed).count(), g_counters };
+    }
+
+    void Print(const char* name, const Result& result, std::size_t events) {
+        double perSecond = static_cast<double>(result.counters.delivered) / result.seconds;
+        double nsPerEvent = result.seconds * 1e9 / static_cast<double>(events);
+        std::printf("%-12s %12llu plugin calls (%5.1f%% of stream) %12.0f calls/s %7.2f ns/event %10llu shout calls\n",
+                    name, static_cast<unsigned long long>(result.counters.delivered),
+                    100.0 * static_cast<double>(result.counters.delivered) / static_cast<double>(events), perSecond,
+                    nsPerEvent, static_cast<unsigned long long>(result.counters.handled));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    auto events = GenerateHeavyCombat(count);
+
+    // Warm up caches and branch predictors once for each path
+    RunActionSink(events);
+    RunVoiceHook(events);
+
+    auto before = RunActionSink(events);
+    auto after = RunVoiceHook(events);
+
+    std::printf("Synthetic heavy-combat stream: %zu action events\n", count);
+    Print("action sink", before, count);
+    Print("voice hook", after, count);
+
+    // The sink sees both the cast and the fire action of a shout; the hook sees the one spell cast per shout
+    std::uint64_t voiceFires = 0;
+    for (const auto& event : events) {
+        voiceFires += event.type == ActionType::kVoiceFire;
+    }
+    if (after.counters.handled != voiceFires) {
+        std::printf("error: voice hook saw %llu of %llu shouts\n",
+                    static_cast<unsigned long long>(after.counters.handled),
+                    static_cast<unsigned long long>(voiceFires));
+        return 1;
+    }
+    std::printf("plugin calls reduced %.1fx\n",
+                static_cast<double>(before.counters.delivered) / static_cast<double>(after.counters.delivered));
+    return 0;
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <vector>
+
+#include "core/Archetypes.h"
+#include "core/PlanCache.h"
+
+// Stand-ins for the CommonLib forms the core reads, with the same member names, plus a generator for synthetic load
+// orders. Forms are allocated once per load order and never move, like the game's. FormIDs encode the form type in the
+// top byte and the creation index below it, and lookups resolve against the most recently constructed load order, as
+// the game resolves against its one data handler.
+namespace Mock {
+    enum FormType : std::uint32_t { kShoutType = 0x01000000, kSpellType = 0x02000000, kProjectileType = 0x03000000 };
+
+    struct BGSProjectile {
+        struct Data {
+            float speed;
+            float range;
+        } data;
+        std::uint32_t formID;
+    };
+
+    struct EffectSetting {
+        struct Data {
+            BGSProjectile* projectileBase;
+        } data;
+        std::uint32_t archetype;  // Core::Archetype
+    };
+
+    struct Effect {
+        struct EffectItem {
+            float magnitude;
+            std::uint32_t area;
+            std::uint32_t duration;
+        } effectItem;
+        EffectSetting* baseEffect;
+    };
+
+    struct SpellItem {
+        std::vector<Effect*> effects;
+        std::uint32_t formID;
+    };
+
+    struct TESWordOfPower {
+        bool known;
+    };
+
+    struct TESShout {
+        struct Variation {
+            TESWordOfPower* word;
+            SpellItem* spell;
+            float recoveryTime;
+        };
+
+        Variation variations[3];
+        std::uint32_t index;
+        std::uint32_t formID;
+    };
+
+    struct Forms {
+        using Shout = TESShout;
+        using Spell = SpellItem;
+
+        static std::uint32_t GetArchetype(EffectSetting* effect) { return effect->archetype; }
+        static bool IsWordKnown(TESWordOfPower* word) { return word->known; }
+
+        template <class T>
+        static std::uint32_t GetFormID(const T* form) {
+            return form->formID;
+        }
+
+        static Shout* LookupShout(std::uint32_t formID);
+        static void* Resolve(const Core::RecordKey& key);
+    };
+
+    struct LoadOrderSpec {
+        std::uint32_t shouts = 4000;
+        std::uint32_t minEffects = 1;
+        std::uint32_t maxEffects = 20;
+        std::uint32_t effectSettings = 512;  // distinct magic effects shared by all spells
+        std::uint32_t projectiles = 64;      // distinct projectiles shared by all magic effects
+        std::uint32_t playerShouts = 120;    // shouts the player has, spread across the load order
+        std::uint32_t seed = 1;
+    };
+
+    class LoadOrder {
+    public:
+        explicit LoadOrder(const LoadOrderSpec& spec) {
+            std::uint64_t state = 0x9E3779B97F4A7C15ull ^ spec.seed;
+            auto next = [&state](std::uint32_t bound) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                return static_cast<std::uint32_t>(state % bound);
+            };
+
+            for (std::uint32_t i = 0; i < spec.projectiles; i++) {
+                auto speed = 1000.0f + static_cast<float>(next(4000));
+                auto range = 500.0f + static_cast<float>(next(8000));
+                projectiles.push_back({ { speed, range }, kProjectileType | i });
+            }
+            // Archetypes seen in vanilla and modded shouts; damage dominates, a few are SlowTime
+            constexpr Core::Archetype ARCHETYPES[] = {
+                Core::Archetype::kValueModifier, Core::Archetype::kValueModifier, Core::Archetype::kValueModifier,
+                Core::Archetype::kStagger,       Core::Archetype::kParalysis,     Core::Archetype::kCalm,
+                Core::Archetype::kFrenzy,        Core::Archetype::kDisarm,        Core::Archetype::kEtherealize,
+                Core::Archetype::kSummonCreature, Core::Archetype::kCloak,        Core::Archetype::kLight,
+                Core::Archetype::kScript
+            };
+            constexpr auto ARCHETYPE_COUNT = static_cast<std::uint32_t>(std::size(ARCHETYPES));
+
+            for (std::uint32_t i = 0; i < spec.effectSettings; i++) {
+                // Most shout effects fire a projectile
+                auto* projectile = next(10) < 7 ? &projectiles[next(spec.projectiles)] : nullptr;
+                auto archetype = next(100) < 3 ? Core::Archetype::kSlowTime : ARCHETYPES[next(ARCHETYPE_COUNT)];
+                effectSettings.push_back({ { projectile }, static_cast<std::uint32_t>(archetype) });
+            }
+
+            for (std::uint32_t i = 0; i < spec.shouts; i++) {
+                auto& shout = shouts.emplace_back();
+                shout.index = i;
+                shout.formID = kShoutType | i;
+                for (auto& variation : shout.variations) {
+                    variation.word = &words.emplace_back(TESWordOfPower{ next(2) == 0 });
+                    variation.recoveryTime = 5.0f + static_cast<float>(next(100));
+
+                    auto& spell = spells.emplace_back();
+                    spell.formID = kSpellType | static_cast<std::uint32_t>(spells.size() - 1);
+                    auto count = spec.minEffects + next(spec.maxEffects - spec.minEffects + 1);
+                    spell.effects.reserve(count);
+                    for (std::uint32_t e = 0; e < count; e++) {
+                        auto& effect = effects.emplace_back();
+                        effect.effectItem = { 1.0f + static_cast<float>(next(200)), next(20), next(60) };
+                        effect.baseEffect = &effectSettings[next(spec.effectSettings)];
+                        spell.effects.push_back(&effect);
+                    }
+                    variation.spell = &spell;
+                }
+            }
+
+            for (auto& shout : shouts) {
+                all.push_back(&shout);
+            }
+
+            playerHas.assign(spec.shouts, 0);
+            auto stride = spec.playerShouts && spec.shouts > spec.playerShouts ? spec.shouts / spec.playerShouts : 1;
+            for (std::uint32_t i = 0; i < spec.playerShouts && i * stride < spec.shouts; i++) {
+                player.push_back(all[i * stride]);
+                playerHas[i * stride] = 1;
+            }
+
+            Active() = this;
+        }
+
+        ~LoadOrder() {
+            if (Active() == this) {
+                Active() = nullptr;
+            }
+        }
+
+        LoadOrder(const LoadOrder&) = delete;
+        LoadOrder& operator=(const LoadOrder&) = delete;
+
+        static LoadOrder*& Active() {
+            static LoadOrder* active = nullptr;
+            return active;
+        }
+
+        std::vector<TESShout*> all;
+        std::vector<TESShout*> player;          // the player's shout list (actorEffects->shouts)
+        std::vector<std::uint8_t> playerHas;    // indexed by TESShout::index, stands in for Actor::HasShout
+
+        std::size_t CountEffects() const { return effects.size(); }
+
+        struct SharedProjectile {
+            TESShout* first;
+            TESShout* second;
+            BGSProjectile* projectile;
+        };
+
+        // The first two shouts in the load order whose spells fire the same projectile; all null when none do
+        SharedProjectile FindSharedProjectile() const {
+            std::vector<TESShout*> firedBy(projectiles.size(), nullptr);
+            for (auto* shout : all) {
+                for (const auto& variation : shout->variations) {
+                    for (const auto* effect : variation.spell->effects) {
+                        auto* projectile = effect->baseEffect->data.projectileBase;
+                        if (!projectile) {
+                            continue;
+                        }
+                        auto& other = firedBy[projectile->formID & 0x00FFFFFF];
+                        if (other && other != shout) {
+                            return { other, shout, projectile };
+                        }
+                        other = shout;
+                    }
+                }
+            }
+            return { nullptr, nullptr, nullptr };
+        }
+
+    private:
+        friend struct Forms;
+
+        template <class T>
+        static T* Find(std::deque<T>& forms, std::uint32_t formID, FormType type) {
+            auto index = formID & 0x00FFFFFF;
+            return (formID & 0xFF000000) == type && index < forms.size() ? &forms[index] : nullptr;
+        }
+
+        std::deque<BGSProjectile> projectiles;
+        std::deque<EffectSetting> effectSettings;
+        std::deque<Effect> effects;
+        std::deque<SpellItem> spells;
+        std::deque<TESWordOfPower> words;
+        std::deque<TESShout> shouts;
+    };
+
+    inline TESShout* Forms::LookupShout(std::uint32_t formID) {
+        auto* loadOrder = LoadOrder::Active();
+        return loadOrder ? LoadOrder::Find(loadOrder->shouts, formID, kShoutType) : nullptr;
+    }
+
+    inline void* Forms::Resolve(const Core::RecordKey& key) {
+        auto* loadOrder = LoadOrder::Active();
+        if (!loadOrder) {
+            return nullptr;
+        }
+        switch (key.field) {
+            case Core::Field::kRecoveryTime: {
+                auto* shout = LoadOrder::Find(loadOrder->shouts, key.owner, kShoutType);
+                return shout && key.index < 3 ? &shout->variations[key.index].recoveryTime : nullptr;
+            }
+            case Core::Field::kMagnitude:
+            case Core::Field::kDuration:
+            case Core::Field::kArea: {
+                auto* spell = LoadOrder::Find(loadOrder->spells, key.owner, kSpellType);
+                if (!spell || key.index >= spell->effects.size()) {
+                    return nullptr;
+                }
+                auto& item = spell->effects[key.index]->effectItem;
+                return key.field == Core::Field::kMagnitude ? static_cast<void*>(&item.magnitude)
+                       : key.field == Core::Field::kDuration ? static_cast<void*>(&item.duration)
+                                                             : static_cast<void*>(&item.area);
+            }
+            case Core::Field::kProjectileSpeed:
+            case Core::Field::kProjectileRange: {
+                auto* projectile = LoadOrder::Find(loadOrder->projectiles, key.owner, kProjectileType);
+                if (!projectile) {
+                    return nullptr;
+                }
+                return key.field == Core::Field::kProjectileSpeed ? &projectile->data.speed : &projectile->data.range;
+            }
+        }
+        return nullptr;
+    }
+}
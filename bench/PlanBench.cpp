@@ -0,0 +1,347 @@
+// Times the core cast, NPC-restore and soul-count paths against a synthetic load order.
+//
+//   ShoutProgressionPlanBench [shouts] [ops]
+//
+// The load order has `shouts` shouts (default 4000) with three variations each, 1-20 effects per variation spell,
+// and magic effects and projectiles drawn from small shared pools, so most projectiles are shared by many shouts.
+// The plan cache is written to and loaded from the system temporary directory. Exits with 1 when any steady-state
+// path (everything after the build and the first batch) allocates.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "DefaultCurves.h"
+#include "MockForms.h"
+#include "core/ShoutPlan.h"
+#include "core/SpentSouls.h"
+
+namespace {
+    using Plan = Core::Plan<Mock::Forms>;
+}
+
+int main(int argc, char** argv) {
+    Mock::LoadOrderSpec spec;
+    if (argc > 1) {
+        spec.shouts = static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    std::uint64_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+    if (spec.shouts == 0 || ops == 0) {
+        std::fprintf(stderr, "usage: %s [shouts] [ops]\n", argv[0]);
+        return 1;
+    }
+
+    Mock::LoadOrder loadOrder(spec);
+    const auto& shouts = loadOrder.all;
+    const auto shoutCount = shouts.size();
+    Bench::DefaultCurves tables;
+
+    std::printf("Synthetic load order: %zu shouts, %zu effects, %u magic effects, %u projectiles\n", shoutCount,
+                loadOrder.CountEffects(), spec.effectSettings, spec.projectiles);
+
+    Plan plan;
+    const Plan::Snapshot* snapshot = nullptr;
+    auto build = Bench::Measure(1, [&](std::uint64_t) { snapshot = plan.Build(shouts); });
+    std::printf("Plan built: %zu records, %zu bytes\n\n", snapshot->records.size(), snapshot->GetMemoryFootprint());
+    auto perShout = static_cast<double>(shoutCount);
+    Bench::Report("build (per shout)", { build.nsPerOp / perShout, build.allocationsPerOp / perShout });
+
+    // Parallel build: wall time and the slowest worker, and a check that the plan matches the serial one
+    for (unsigned threads = 2, cores = std::max(2u, std::thread::hardware_concurrency()); threads <= cores;
+         threads *= 2) {
+        Plan parallel;
+        const Plan::Snapshot* result = nullptr;
+        std::vector<Core::WorkerStats> workers;
+        auto timed =
+            Bench::Measure(1, [&](std::uint64_t) { result = parallel.Build(shouts, nullptr, threads, &workers); });
+
+        if (result->records.size() != snapshot->records.size() ||
+            !std::equal(result->records.begin(), result->records.end(), snapshot->records.begin(),
+                        [](const Core::Record& a, const Core::Record& b) {
+                            return a.target == b.target && a.transform == b.transform;
+                        })) {
+            std::fprintf(stderr, "parallel build with %u threads differs from the serial build\n", threads);
+            return 1;
+        }
+
+        std::uint64_t slowest = 0;
+        for (const auto& worker : workers) {
+            slowest = std::max(slowest, worker.nanoseconds);
+        }
+        char name[48];
+        std::snprintf(name, sizeof(name), "build x%u (per shout)", threads);
+        Bench::Report(name, { timed.nsPerOp / perShout, timed.allocationsPerOp / perShout });
+        std::printf("%-28s %10.1f us\n", "  slowest worker", static_cast<double>(slowest) / 1000.0);
+    }
+
+    // Plan cache round trip, timed before anything is scaled so every cached value still matches its form
+    {
+        auto cachePath = std::filesystem::temp_directory_path() / "ShoutProgressionPlanBench.plancache";
+        constexpr std::uint64_t LOAD_ORDER_HASH = 1;
+
+        Plan cachePlan;
+        Core::PlanCacheData data;
+        const Plan::Snapshot* built = nullptr;
+        auto write = Bench::Measure(1, [&](std::uint64_t) {
+            data = {};
+            built = cachePlan.Build(shouts, &data);
+            if (!Core::WritePlanCache(cachePath, LOAD_ORDER_HASH, data)) {
+                std::fprintf(stderr, "cannot write %s\n", cachePath.string().c_str());
+                std::exit(1);
+            }
+        });
+        Bench::Report("build + write cache (per shout)",
+                      { write.nsPerOp / perShout, write.allocationsPerOp / perShout });
+
+        std::string error;
+        const Plan::Snapshot* loaded = nullptr;
+        auto load = Bench::Measure(1, [&](std::uint64_t) {
+            Core::PlanCacheView cache;
+            if (cache.Open(cachePath, LOAD_ORDER_HASH, error)) {
+                loaded = cachePlan.BuildFromCache(cache, error);
+            }
+        });
+        if (!loaded || loaded->records.size() != snapshot->records.size()) {
+            std::fprintf(stderr, "plan cache did not round-trip: %s\n", error.c_str());
+            return 1;
+        }
+        Bench::Report("load cache (per shout)", { load.nsPerOp / perShout, load.allocationsPerOp / perShout });
+
+        // The load rebuilt the plan; the snapshot it retired still points at valid states
+        for (const auto& entry : built->entries) {
+            if (entry.state->stamp.load(std::memory_order_relaxed) != Plan::RESTORED) {
+                std::fprintf(stderr, "FAILED: a rebuild freed the states of the snapshot it retired\n");
+                return 1;
+            }
+        }
+
+        Core::PlanCacheView stale;
+        if (stale.Open(cachePath, LOAD_ORDER_HASH + 1, error)) {
+            std::fprintf(stderr, "plan cache accepted a different load order\n");
+            return 1;
+        }
+
+        // Same load order and values, but a magic effect now fires another projectile
+        auto* effect = shouts[0]->variations[0].spell->effects[0]->baseEffect;
+        auto* projectile = effect->data.projectileBase;
+        effect->data.projectileBase = shouts[1]->variations[0].spell->effects[0]->baseEffect->data.projectileBase;
+        if (effect->data.projectileBase == projectile) {
+            effect->data.projectileBase = nullptr;
+        }
+        {
+            Core::PlanCacheView swapped;
+            if (swapped.Open(cachePath, LOAD_ORDER_HASH, error) && cachePlan.BuildFromCache(swapped, error)) {
+                std::fprintf(stderr, "plan cache accepted a swapped projectile\n");
+                return 1;
+            }
+        }
+        effect->data.projectileBase = projectile;
+        std::filesystem::remove(cachePath);
+    }
+
+    // A projectile shared by two shouts holds the values of whichever was cast last: the player casts one, an NPC
+    // with fewer souls casts the other, and the player casts the first again. Runs before anything else is scaled,
+    // so the projectile still holds its original speed.
+    {
+        auto shared = loadOrder.FindSharedProjectile();
+        if (!shared.projectile) {
+            std::fprintf(stderr, "no two shouts share a projectile\n");
+            return 1;
+        }
+        auto original = shared.projectile->data.speed;
+        bool holds = true;
+        auto cast = [&](Mock::TESShout* shout, int souls) {
+            auto multipliers = tables.For(souls);
+            plan.Apply(shout, multipliers, Core::MakeStamp(1, souls));
+            holds &= shared.projectile->data.speed == original * multipliers.distance;
+        };
+        for (int round = 0; round < 2; round++) {
+            cast(shared.first, 40);
+            cast(shared.second, 5);
+        }
+        cast(shared.first, 40);
+        plan.Restore(shared.first);
+        plan.Restore(shared.second);
+        holds &= shared.projectile->data.speed == original;
+        if (!holds) {
+            std::fprintf(stderr, "FAILED: a shared projectile kept another shout's values\n");
+            return 1;
+        }
+
+        // The second shout compiled late, while the first holds the projectile scaled: restoring both must bring back
+        // the original speed, not the scaled one the late compile found in the form
+        std::vector<Mock::TESShout*> withoutSecond;
+        std::copy_if(shouts.begin(), shouts.end(), std::back_inserter(withoutSecond),
+                     [&](Mock::TESShout* shout) { return shout != shared.second; });
+        Plan late;
+        late.Build(withoutSecond);
+        late.Apply(shared.first, tables.For(40), Core::MakeStamp(1, 40));
+        late.Apply(shared.second, tables.For(40), Core::MakeStamp(1, 40));
+        late.Restore(shared.first);
+        late.Restore(shared.second);
+        if (shared.projectile->data.speed != original) {
+            std::fprintf(stderr, "FAILED: a late compile captured a scaled value as the original\n");
+            return 1;
+        }
+    }
+
+    // Player cast with a soul total the shout was not scaled for: the full record run is written
+    auto castMiss = Bench::Measure(ops, [&](std::uint64_t i) {
+        int souls = static_cast<int>(i);
+        Bench::DoNotOptimize(plan.Apply(shouts[i % shoutCount], tables.For(souls), Core::MakeStamp(1, souls)));
+    });
+    Bench::Report("cast (scaled)", castMiss);
+    bool steady = Bench::ExpectNoAllocations("cast (scaled)", castMiss);
+
+    // Player cast with nothing changed: the applied-state cache skips the writes
+    plan.Apply(shouts[0], tables.For(20), Core::MakeStamp(1, 20));
+    auto castHit = Bench::Measure(ops, [&](std::uint64_t) {
+        Bench::DoNotOptimize(plan.Apply(shouts[0], tables.For(20), Core::MakeStamp(1, 20)));
+    });
+    Bench::Report("cast (cached)", castHit);
+    steady &= Bench::ExpectNoAllocations("cast (cached)", castHit);
+
+    // NPC cast of a shout the player scaled: every shout is applied untimed, then restored timed
+    Bench::Result restoreMiss{ 0.0, 0.0 };
+    std::uint64_t rounds = ops / shoutCount ? ops / shoutCount : 1;
+    for (std::uint64_t round = 0; round < rounds; round++) {
+        for (auto* shout : shouts) {
+            plan.Apply(shout, tables.For(static_cast<int>(round)), Core::MakeStamp(2, static_cast<int>(round)));
+        }
+        auto result = Bench::Measure(shoutCount,
+                                     [&](std::uint64_t i) { Bench::DoNotOptimize(plan.Restore(shouts[i])); });
+        restoreMiss.nsPerOp += result.nsPerOp / static_cast<double>(rounds);
+        restoreMiss.allocationsPerOp += result.allocationsPerOp / static_cast<double>(rounds);
+    }
+    Bench::Report("NPC restore (scaled)", restoreMiss);
+    steady &= Bench::ExpectNoAllocations("NPC restore (scaled)", restoreMiss);
+
+    auto restoreHit = Bench::Measure(ops, [&](std::uint64_t) { Bench::DoNotOptimize(plan.Restore(shouts[0])); });
+    Bench::Report("NPC restore (cached)", restoreHit);
+    steady &= Bench::ExpectNoAllocations("NPC restore (cached)", restoreHit);
+
+    // Soul total changed: the player's shouts are prepared as one batch off the game thread, then committed. Each
+    // iteration uses a new soul total, so every commit writes the whole batch.
+    {
+        Plan::Batch batch;
+        std::uint64_t batchOps = ops / 1000 ? ops / 1000 : 1;
+        double prepareNs = 0.0;
+        double commitNs = 0.0;
+        double prepareAllocations = 0.0;
+        double commitAllocations = 0.0;
+        for (std::uint64_t i = 0; i < batchOps; i++) {
+            int souls = static_cast<int>(i % 50);
+            auto stamp = Core::MakeStamp(3, static_cast<int>(i));
+            auto prepare = Bench::Measure(1, [&](std::uint64_t) {
+                plan.Prepare(loadOrder.player, [&](const Mock::TESShout*) { return tables.For(souls); }, stamp, batch);
+            });
+            auto commit = Bench::Measure(1, [&](std::uint64_t) { Bench::DoNotOptimize(plan.Commit(batch)); });
+            prepareNs += prepare.nsPerOp;
+            commitNs += commit.nsPerOp;
+            if (i != 0) {  // the first prepare sizes the batch
+                prepareAllocations += prepare.allocationsPerOp;
+                commitAllocations += commit.allocationsPerOp;
+            }
+        }
+        auto n = static_cast<double>(batchOps);
+        auto steadyOps = n > 1 ? n - 1 : 1;
+        std::printf("Batch: %zu shouts, %zu records\n", batch.entries.size(), batch.values.size());
+        Bench::Result prepare{ prepareNs / n, prepareAllocations / steadyOps };
+        Bench::Result commit{ commitNs / n, commitAllocations / steadyOps };
+        Bench::Report("batch prepare", prepare);
+        Bench::Report("batch commit", commit);
+        steady &= Bench::ExpectNoAllocations("batch prepare", prepare);
+        steady &= Bench::ExpectNoAllocations("batch commit", commit);
+
+        // The cast after a commit only finds its stamp current
+        auto* shout = batch.entries.empty() ? shouts[0] : batch.entries[0]->shout;
+        auto castAfterBatch = Bench::Measure(ops, [&](std::uint64_t) {
+            Bench::DoNotOptimize(plan.Apply(shout, tables.For(static_cast<int>((batchOps - 1) % 50)),
+                                            Core::MakeStamp(3, static_cast<int>(batchOps - 1))));
+        });
+        Bench::Report("cast after batch", castAfterBatch);
+        steady &= Bench::ExpectNoAllocations("cast after batch", castAfterBatch);
+    }
+
+    std::vector<const Mock::SpellItem*> spells;
+    for (auto* shout : shouts) {
+        for (auto& variation : shout->variations) {
+            spells.push_back(variation.spell);
+        }
+    }
+    auto spellLookup = Bench::Measure(ops, [&](std::uint64_t i) {
+        Bench::DoNotOptimize(plan.FindShoutBySpell(spells[(i * 7919) % spells.size()]));
+    });
+    Bench::Report("spell -> shout lookup", spellLookup);
+    steady &= Bench::ExpectNoAllocations("spell -> shout lookup", spellLookup);
+
+    const auto& playerShouts = loadOrder.player;
+    auto recount = [&]() {
+        return Core::CountKnownWords<Mock::Forms>(playerShouts.data(), static_cast<std::uint32_t>(playerShouts.size()));
+    };
+
+    const auto playerCount = static_cast<std::uint32_t>(playerShouts.size());
+    Core::SpentSoulCache cache;
+    cache.Get(Core::HashShoutList(playerShouts.data(), playerCount), recount);
+    auto soulsCached = Bench::Measure(ops, [&](std::uint64_t) {
+        Bench::DoNotOptimize(cache.Get(Core::HashShoutList(playerShouts.data(), playerCount), recount));
+    });
+    Bench::Report("soul count (cached)", soulsCached);
+    steady &= Bench::ExpectNoAllocations("soul count (cached)", soulsCached);
+
+    auto soulsRecount = Bench::Measure(ops / 10 ? ops / 10 : 1, [&](std::uint64_t) {
+        cache.MarkDirty();
+        Bench::DoNotOptimize(cache.Get(Core::HashShoutList(playerShouts.data(), playerCount), recount));
+    });
+    Bench::Report("soul count (word learned)", soulsRecount);
+    steady &= Bench::ExpectNoAllocations("soul count (word learned)", soulsRecount);
+
+    // A script removing one shout and adding another keeps the list size, but not the signature
+    {
+        auto swapped = playerShouts;
+        for (auto* shout : shouts) {
+            if (!loadOrder.playerHas[shout->index]) {
+                swapped.back() = shout;
+                break;
+            }
+        }
+        bool recounted = false;
+        cache.Get(Core::HashShoutList(swapped.data(), playerCount), [&]() {
+            recounted = true;
+            return recount();
+        });
+        if (!recounted) {
+            std::fprintf(stderr, "FAILED: replacing a shout did not recount the spent souls\n");
+            steady = false;
+        }
+    }
+
+    // Reference: every shout in the load order, filtered by whether the player has it
+    auto soulsFullScan = Bench::Measure(ops / 100 ? ops / 100 : 1, [&](std::uint64_t) {
+        int words = 0;
+        for (auto* shout : shouts) {
+            if (loadOrder.playerHas[shout->index]) {
+                words += Core::CountKnownWords<Mock::Forms>(shout);
+            }
+        }
+        Bench::DoNotOptimize(words);
+    });
+    Bench::Report("soul count (full scan)", soulsFullScan);
+
+    auto stats = plan.GetCacheStats();
+    std::printf("\nApplied-state cache: %llu/%llu apply hits, %llu/%llu restore hits\n",
+                static_cast<unsigned long long>(stats.applyHits),
+                static_cast<unsigned long long>(stats.applyHits + stats.applyMisses),
+                static_cast<unsigned long long>(stats.restoreHits),
+                static_cast<unsigned long long>(stats.restoreHits + stats.restoreMisses));
+
+    std::printf("\n");
+    Bench::ReportMemory();
+    return steady ? 0 : 1;
+}
@@ -0,0 +1,372 @@
+// Times the offline plan compiler's plugin reader on a synthetic load order written to disk, and checks that the plan
+// compiled from the files matches the plan compiled from the same forms in memory, and that the cache written from it
+// is accepted under the load-order hash the plugin computes in game.
+//
+//   ShoutProgressionPluginBench [shouts] [filler MB per plugin] [directory]
+//
+// The mock load order is written as Synth.esm, with every fourth spell compressed when zlib is available. Filler.esl
+// and Patch.esp both override every sixteenth projectile; Patch.esp is listed first, so the result only matches if the
+// reader moves the light master ahead of it and lets Patch.esp win, as the game does. Each plugin also carries a
+// filler group of the given size standing in for cells and worldspaces, which the reader must skip without reading.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if SHOUTPROGRESSION_HAS_ZLIB
+    #include <zlib.h>
+#endif
+
+#include "BenchSupport.h"
+#include "MockForms.h"
+#include "core/PluginReader.h"
+#include "core/ShoutPlan.h"
+
+namespace {
+    std::vector<char> Bytes(std::string_view text) { return { text.begin(), text.end() }; }
+
+    constexpr std::uint32_t PROJECTILE_IDS = 0x100000;
+    constexpr std::uint32_t EFFECT_IDS = 0x200000;
+    constexpr std::uint32_t SPELL_IDS = 0x300000;
+    constexpr std::uint32_t SHOUT_IDS = 0x400000;
+    constexpr std::uint32_t WORD_IDS = 0x500000;
+    constexpr std::uint32_t OVERRIDE_STRIDE = 16;
+
+    class PluginWriter {
+    public:
+        explicit PluginWriter(std::uint32_t flags, const std::vector<std::string>& masters) {
+            std::vector<char> fields;
+            Field(fields, "HEDR", std::vector<char>(12));
+            for (const auto& master : masters) {
+                Field(fields, "MAST", Bytes(master), true);
+                Field(fields, "DATA", std::vector<char>(8));
+            }
+            Record("TES4", 0, flags, fields);
+        }
+
+        static void Field(std::vector<char>& out, const char* tag, const std::vector<char>& data,
+                          bool zstring = false) {
+            auto size = static_cast<std::uint16_t>(data.size() + (zstring ? 1 : 0));
+            out.insert(out.end(), tag, tag + 4);
+            Append(out, size);
+            out.insert(out.end(), data.begin(), data.end());
+            if (zstring) {
+                out.push_back('\0');
+            }
+        }
+
+        template <class T>
+        static void Append(std::vector<char>& out, const T& value) {
+            const auto* bytes = reinterpret_cast<const char*>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <class T>
+        static void Put(std::vector<char>& data, std::size_t offset, const T& value) {
+            std::memcpy(data.data() + offset, &value, sizeof(T));
+        }
+
+        void BeginGroup(const char* label) {
+            _groupStart = _out.size();
+            _out.insert(_out.end(), "GRUP", "GRUP" + 4);
+            Append(_out, std::uint32_t{ 0 });
+            _out.insert(_out.end(), label, label + 4);
+            _out.insert(_out.end(), 12, '\0');
+        }
+
+        void EndGroup() {
+            auto size = static_cast<std::uint32_t>(_out.size() - _groupStart);
+            std::memcpy(_out.data() + _groupStart + 4, &size, sizeof(size));
+        }
+
+        void Record(const char* type, std::uint32_t formID, std::uint32_t flags, const std::vector<char>& fields,
+                    bool compress = false) {
+            std::vector<char> data = fields;
+#if SHOUTPROGRESSION_HAS_ZLIB
+            if (compress) {
+                auto bound = compressBound(static_cast<uLong>(fields.size()));
+                data.assign(4 + bound, '\0');
+                auto length = static_cast<uLongf>(bound);
+                ::compress(reinterpret_cast<Bytef*>(data.data() + 4), &length,
+                           reinterpret_cast<const Bytef*>(fields.data()), static_cast<uLong>(fields.size()));
+                Put(data, 0, static_cast<std::uint32_t>(fields.size()));
+                data.resize(4 + length);
+                flags |= 0x00040000;
+            }
+#else
+            (void)compress;
+#endif
+            _out.insert(_out.end(), type, type + 4);
+            Append(_out, static_cast<std::uint32_t>(data.size()));
+            Append(_out, flags);
+            Append(_out, formID);
+            _out.insert(_out.end(), 8, '\0');
+            _out.insert(_out.end(), data.begin(), data.end());
+        }
+
+        // A top-level group the reader never enters, written in chunks so it does not have to fit in memory
+        bool Write(const std::filesystem::path& path, std::uint64_t fillerBytes) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(_out.data(), static_cast<std::streamsize>(_out.size()));
+            if (fillerBytes != 0) {
+                std::vector<char> header;
+                header.insert(header.end(), "GRUP", "GRUP" + 4);
+                Append(header, static_cast<std::uint32_t>(24 + fillerBytes));
+                header.insert(header.end(), "CELL", "CELL" + 4);
+                header.insert(header.end(), 12, '\0');
+                file.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+                std::vector<char> chunk(1 << 20, '\x5A');
+                for (std::uint64_t written = 0; written < fillerBytes; written += chunk.size()) {
+                    auto size = std::min<std::uint64_t>(chunk.size(), fillerBytes - written);
+                    file.write(chunk.data(), static_cast<std::streamsize>(size));
+                }
+            }
+            return static_cast<bool>(file);
+        }
+
+    private:
+        std::vector<char> _out;
+        std::size_t _groupStart = 0;
+    };
+
+    std::vector<char> ProjectileFields(const Mock::BGSProjectile& projectile, std::uint32_t id) {
+        std::vector<char> fields;
+        std::vector<char> data(92);
+        PluginWriter::Put(data, 8, projectile.data.speed);
+        PluginWriter::Put(data, 12, projectile.data.range);
+        PluginWriter::Field(fields, "EDID", Bytes("SynthProjectile" + std::to_string(id)), true);
+        PluginWriter::Field(fields, "DATA", data);
+        return fields;
+    }
+
+    // Writes the mock forms reachable from the shouts. Returns the projectile IDs, for the override plugins.
+    std::unordered_map<const Mock::BGSProjectile*, std::uint32_t> WriteMaster(const Mock::LoadOrder& mock,
+                                                                              PluginWriter& writer, bool compress) {
+        std::unordered_map<const Mock::BGSProjectile*, std::uint32_t> projectiles;
+        std::unordered_map<const Mock::EffectSetting*, std::uint32_t> effects;
+        std::vector<const Mock::BGSProjectile*> projectileOrder;
+        std::vector<const Mock::EffectSetting*> effectOrder;
+        for (const auto* shout : mock.all) {
+            for (const auto& variation : shout->variations) {
+                for (const auto* effect : variation.spell->effects) {
+                    const auto* base = effect->baseEffect;
+                    if (effects.try_emplace(base, EFFECT_IDS + static_cast<std::uint32_t>(effects.size())).second) {
+                        effectOrder.push_back(base);
+                    }
+                    const auto* projectile = base->data.projectileBase;
+                    auto id = PROJECTILE_IDS + static_cast<std::uint32_t>(projectiles.size());
+                    if (projectile && projectiles.try_emplace(projectile, id).second) {
+                        projectileOrder.push_back(projectile);
+                    }
+                }
+            }
+        }
+
+        writer.BeginGroup("PROJ");
+        for (const auto* projectile : projectileOrder) {
+            auto id = projectiles[projectile];
+            writer.Record("PROJ", id, 0, ProjectileFields(*projectile, id));
+        }
+        writer.EndGroup();
+
+        writer.BeginGroup("MGEF");
+        for (const auto* effect : effectOrder) {
+            std::vector<char> fields;
+            std::vector<char> data(152);
+            PluginWriter::Put(data, 64, effect->archetype);
+            auto projectile = effect->data.projectileBase ? projectiles[effect->data.projectileBase] : 0;
+            PluginWriter::Put(data, 72, projectile);
+            PluginWriter::Field(fields, "DATA", data);
+            writer.Record("MGEF", effects[effect], 0, fields);
+        }
+        writer.EndGroup();
+
+        writer.BeginGroup("SPEL");
+        std::uint32_t spellID = SPELL_IDS;
+        for (const auto* shout : mock.all) {
+            for (const auto& variation : shout->variations) {
+                std::vector<char> fields;
+                PluginWriter::Field(fields, "SPIT", std::vector<char>(36));
+                for (const auto* effect : variation.spell->effects) {
+                    std::vector<char> efid(4);
+                    std::vector<char> efit(12);
+                    PluginWriter::Put(efid, 0, effects[effect->baseEffect]);
+                    PluginWriter::Put(efit, 0, effect->effectItem.magnitude);
+                    PluginWriter::Put(efit, 4, effect->effectItem.area);
+                    PluginWriter::Put(efit, 8, effect->effectItem.duration);
+                    PluginWriter::Field(fields, "EFID", efid);
+                    PluginWriter::Field(fields, "EFIT", efit);
+                }
+                writer.Record("SPEL", spellID, 0, fields, compress && spellID % 4 == 0);
+                spellID++;
+            }
+        }
+        writer.EndGroup();
+
+        writer.BeginGroup("SHOU");
+        spellID = SPELL_IDS;
+        for (const auto* shout : mock.all) {
+            std::vector<char> fields;
+            PluginWriter::Field(fields, "EDID", Bytes("SynthShout" + std::to_string(shout->index)), true);
+            for (std::uint32_t v = 0; v < 3; v++) {
+                std::vector<char> snam(12);
+                PluginWriter::Put(snam, 0, WORD_IDS + shout->index * 3 + v);
+                PluginWriter::Put(snam, 4, spellID++);
+                PluginWriter::Put(snam, 8, shout->variations[v].recoveryTime);
+                PluginWriter::Field(fields, "SNAM", snam);
+            }
+            writer.Record("SHOU", SHOUT_IDS + shout->index, 0, fields);
+        }
+        writer.EndGroup();
+        return projectiles;
+    }
+
+    // Every sixteenth projectile, with `edit` applied to a copy
+    template <class F>
+    void WriteOverrides(const std::unordered_map<const Mock::BGSProjectile*, std::uint32_t>& projectiles,
+                        PluginWriter& writer, F&& edit) {
+        std::vector<std::pair<std::uint32_t, Mock::BGSProjectile>> overrides;
+        for (const auto& [projectile, id] : projectiles) {
+            if ((id - PROJECTILE_IDS) % OVERRIDE_STRIDE == 0) {
+                auto copy = *projectile;
+                edit(copy);
+                overrides.emplace_back(id, copy);
+            }
+        }
+        writer.BeginGroup("PROJ");
+        for (const auto& [id, projectile] : overrides) {
+            writer.Record("PROJ", id, 0, ProjectileFields(projectile, id));
+        }
+        writer.EndGroup();
+    }
+
+    bool SameKeys(const Core::PlanCacheData& expected, const Core::PlanCacheData& actual) {
+        if (expected.keys.size() != actual.keys.size() || expected.shouts.size() != actual.shouts.size()) {
+            std::printf("MISMATCH: %zu/%zu keys, %zu/%zu shouts\n", actual.keys.size(), expected.keys.size(),
+                        actual.shouts.size(), expected.shouts.size());
+            return false;
+        }
+        for (std::size_t i = 0; i < expected.keys.size(); i++) {
+            const auto& a = expected.keys[i];
+            const auto& b = actual.keys[i];
+            if (a.field != b.field || a.index != b.index || a.transform != b.transform ||
+                std::memcmp(&a.original, &b.original, sizeof(float)) != 0) {
+                std::printf("MISMATCH at key %zu: %g vs %g\n", i, a.original, b.original);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Mock::LoadOrderSpec spec;
+    if (argc > 1) {
+        spec.shouts = static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    std::uint64_t fillerMB = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256;
+    auto directory = argc > 3 ? std::filesystem::path(argv[3])
+                              : std::filesystem::temp_directory_path() / "ShoutProgressionPluginBench";
+    if (spec.shouts == 0) {
+        std::fprintf(stderr, "usage: %s [shouts] [filler MB per plugin] [directory]\n", argv[0]);
+        return 1;
+    }
+    std::filesystem::create_directories(directory);
+
+#if SHOUTPROGRESSION_HAS_ZLIB
+    constexpr bool COMPRESS = true;
+#else
+    constexpr bool COMPRESS = false;
+#endif
+
+    Mock::LoadOrder mock(spec);
+    const auto filler = fillerMB << 20;
+
+    PluginWriter master(0x1, {});
+    auto projectiles = WriteMaster(mock, master, COMPRESS);
+    PluginWriter light(0x200, { "Synth.esm" });
+    WriteOverrides(projectiles, light, [](Mock::BGSProjectile& projectile) { projectile.data.range = 1.0f; });
+    PluginWriter patch(0, { "Synth.esm" });
+    WriteOverrides(projectiles, patch, [](Mock::BGSProjectile& projectile) { projectile.data.speed *= 2.0f; });
+    if (!master.Write(directory / "Synth.esm", filler) || !light.Write(directory / "Filler.esl", filler) ||
+        !patch.Write(directory / "Patch.esp", filler)) {
+        std::fprintf(stderr, "cannot write plugins to %s\n", directory.string().c_str());
+        return 1;
+    }
+
+    // What the game ends up with: Patch.esp's speeds over the master's ranges
+    for (const auto& [projectile, id] : projectiles) {
+        if ((id - PROJECTILE_IDS) % OVERRIDE_STRIDE == 0) {
+            const_cast<Mock::BGSProjectile*>(projectile)->data.speed *= 2.0f;
+        }
+    }
+    Core::Plan<Mock::Forms> expectedPlan;
+    Core::PlanCacheData expected;
+    expectedPlan.Build(mock.all, &expected);
+
+    std::printf("Synthetic load order: %u shouts, %llu MB filler per plugin, %s\n\n", spec.shouts,
+                static_cast<unsigned long long>(fillerMB), COMPRESS ? "compressed spells" : "no zlib");
+
+    Esp::LoadOrder loadOrder;
+    std::string error;
+    auto allocations = Bench::Allocations();
+    auto start = std::chrono::steady_clock::now();
+    bool read = loadOrder.Read(directory, { "Synth.esm", "Patch.esp", "Filler.esl" }, error);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    allocations = Bench::Allocations() - allocations;
+    if (!read) {
+        std::fprintf(stderr, "read failed: %s\n", error.c_str());
+        return 1;
+    }
+
+    Core::Plan<Esp::Forms> plan;
+    Core::PlanCacheData actual;
+    auto compileStart = std::chrono::steady_clock::now();
+    plan.Build(loadOrder.shouts, &actual);
+    auto compile = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+
+    const auto& stats = loadOrder.GetStats();
+    std::printf("Load order: ");
+    for (const auto& name : loadOrder.GetPlugins()) {
+        std::printf("%s ", name.c_str());
+    }
+    std::printf("\n%.1f MB mapped, %.2f MB walked, %u groups skipped, %u records (%u overridden, %u compressed)\n",
+                static_cast<double>(stats.bytesMapped) / 1e6, static_cast<double>(stats.bytesWalked) / 1e6,
+                stats.groupsSkipped, stats.records, stats.overrides, stats.compressed);
+    std::printf("Read %.1f ms (%.1f GB/s of plugin files, %llu allocations), compile %.1f ms\n", elapsed,
+                static_cast<double>(stats.bytesMapped) / 1e6 / elapsed, static_cast<unsigned long long>(allocations),
+                compile);
+    std::printf("Shared projectiles %zu, shared spells %zu\n", loadOrder.FindSharedProjectiles().size(),
+                loadOrder.FindSharedSpells().size());
+
+    if (!SameKeys(expected, actual)) {
+        return 1;
+    }
+    std::printf("Plan matches the in-memory build: %zu shouts, %zu records\n", actual.shouts.size(),
+                actual.keys.size());
+
+    // The cache the compiler writes, opened with the hash the plugin computes in game. The game keeps its file list
+    // in plugins.txt order, Patch.esp ahead of the light master, and numbers light plugins apart from full ones.
+    std::vector<Core::IndexedPlugin> game{ { "Synth.esm", false, 0 }, { "Patch.esp", false, 1 },
+                                           { "Filler.esl", true, 0 } };
+    auto cachePath = directory / "ShoutProgression.plancache";
+    auto toolHash = Core::HashLoadOrder(directory, loadOrder.GetCanonicalPlugins(), loadOrder.shouts.size());
+    auto gameHash = Core::HashLoadOrder(directory, Core::CanonicalLoadOrder(game), loadOrder.shouts.size());
+    Core::PlanCacheView cache;
+    Core::Plan<Esp::Forms> cached;
+    if (!Core::WritePlanCache(cachePath, toolHash, actual) || !cache.Open(cachePath, gameHash, error) ||
+        !cached.BuildFromCache(cache, error)) {
+        std::printf("MISMATCH: the game rejects the compiler's cache (%s)\n", error.c_str());
+        return 1;
+    }
+    std::printf("Compiler's cache accepted under the game's load order\n");
+    return 0;
+}
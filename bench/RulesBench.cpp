@@ -0,0 +1,157 @@
+// Times compiling per-shout override rules and the per-cast rule lookup as the rule count grows.
+//
+//   ShoutProgressionRulesBench [shouts] [ops]
+//
+// Each rule set mixes FormID selectors over random shouts with a few archetype selectors, and every tenth rule
+// replaces a curve, which is roughly what large shout overhaul rule files look like. The lookup resolves the rule for
+// a random shout in the load order and applies it to the global multipliers, as ShoutHandler::GetMultipliers does.
+//
+// Before timing, two shouts sharing a projectile are cast in turn, one of them under a rule that leaves distance
+// unscaled (bScaleDistance=false), and the projectile is checked to hold the last cast shout's speed each time.
+// Exits with 1 when it does not, or when the lookup allocates.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "DefaultCurves.h"
+#include "MockForms.h"
+#include "core/ShoutPlan.h"
+#include "core/ShoutRules.h"
+
+namespace {
+    Core::ShoutRules MakeRules(const Mock::LoadOrder& loadOrder, std::uint32_t ruleCount, std::uint32_t seed,
+                               double& compileNs) {
+        std::uint64_t state = 0x2545F4914F6CDD1Dull ^ seed;
+        auto next = [&state](std::uint32_t bound) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<std::uint32_t>(state % bound);
+        };
+
+        std::vector<Core::ShoutRule> rules(ruleCount);
+        std::vector<Curves::MultiplierTable> curves;
+        std::vector<Core::RuleSelector> selectors;
+        const auto shoutCount = static_cast<std::uint32_t>(loadOrder.all.size());
+
+        Curves::Curve steep;
+        steep.type = Curves::Type::kPiecewise;
+        steep.points = { { 0.0f, 1.0f }, { 50.0f, 4.0f } };
+
+        for (std::uint32_t i = 0; i < ruleCount; i++) {
+            auto& rule = rules[i];
+            rule.distance.scale = next(4) != 0;
+            rule.cooldown.min = 0.5f;
+            if (i % 10 == 0) {
+                rule.magnitude.curve = static_cast<std::int32_t>(curves.size());
+                curves.emplace_back().Bake(steep, 50);
+            }
+
+            if (i % 50 == 49) {
+                auto archetype = next(static_cast<std::uint32_t>(Core::Archetype::kTotal));
+                selectors.push_back({ Core::RuleSelector::Kind::kArchetype, archetype, i });
+            } else {
+                auto formID = loadOrder.all[next(shoutCount)]->formID;
+                selectors.push_back({ Core::RuleSelector::Kind::kFormID, formID, i });
+            }
+        }
+
+        Core::ShoutRules compiled;
+        auto result = Bench::Measure(1, [&](std::uint64_t) {
+            compiled.Compile<Mock::Forms>(std::move(rules), std::move(curves), selectors, loadOrder.all);
+        });
+        compileNs = result.nsPerOp;
+        return compiled;
+    }
+
+    // Alternates casts of two shouts sharing a projectile, the second excluded from distance scaling by a rule, at
+    // the same soul total: each cast must leave the projectile at its own shout's speed
+    bool CheckSharedProjectile(const Mock::LoadOrder& loadOrder, const Bench::DefaultCurves& tables) {
+        auto shared = loadOrder.FindSharedProjectile();
+        if (!shared.projectile) {
+            std::fprintf(stderr, "no two shouts share a projectile\n");
+            return false;
+        }
+
+        Core::ShoutRule unscaled;
+        unscaled.distance.scale = false;
+        Core::ShoutRules rules;
+        std::vector<Core::RuleSelector> selectors{ { Core::RuleSelector::Kind::kFormID, shared.second->formID, 0 } };
+        rules.Compile<Mock::Forms>({ unscaled }, {}, selectors, loadOrder.all);
+
+        Core::Plan<Mock::Forms> plan;
+        plan.Build(loadOrder.all);
+
+        constexpr int SOULS = 30;
+        auto original = shared.projectile->data.speed;
+        bool holds = true;
+        for (int i = 0; i < 4; i++) {
+            auto* shout = i % 2 == 0 ? shared.first : shared.second;
+            auto multipliers = tables.For(SOULS);
+            if (const auto* rule = rules.Find(shout->formID)) {
+                multipliers = rules.Apply(*rule, multipliers, SOULS);
+            }
+            plan.Apply(shout, multipliers, Core::MakeStamp(1, SOULS));
+            holds &= shared.projectile->data.speed == original * multipliers.distance;
+        }
+        plan.Restore(shared.first);
+        plan.Restore(shared.second);
+        holds &= shared.projectile->data.speed == original;
+
+        if (!holds) {
+            std::fprintf(stderr, "FAILED: a shared projectile kept the values of a shout with another rule\n");
+        }
+        return holds;
+    }
+}
+
+int main(int argc, char** argv) {
+    Mock::LoadOrderSpec spec;
+    if (argc > 1) {
+        spec.shouts = static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    std::uint64_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+    if (spec.shouts == 0 || ops == 0) {
+        std::fprintf(stderr, "usage: %s [shouts] [ops]\n", argv[0]);
+        return 1;
+    }
+
+    Mock::LoadOrder loadOrder(spec);
+    Bench::DefaultCurves tables;
+    const auto& shouts = loadOrder.all;
+
+    std::vector<std::uint32_t> probes(4096);
+    for (std::size_t i = 0; i < probes.size(); i++) {
+        probes[i] = shouts[(i * 2654435761u) % shouts.size()]->formID;
+    }
+
+    if (!CheckSharedProjectile(loadOrder, tables)) {
+        return 1;
+    }
+
+    std::printf("Synthetic load order: %zu shouts\n\n", shouts.size());
+    std::printf("%8s %10s %12s %12s %14s %12s\n", "rules", "shouts", "bytes", "compile us", "lookup ns/op",
+                "allocs/op");
+
+    bool steady = true;
+    for (std::uint32_t ruleCount : { 0u, 10u, 100u, 1000u, 10000u }) {
+        double compileNs = 0.0;
+        auto rules = MakeRules(loadOrder, ruleCount, ruleCount + 1, compileNs);
+
+        auto lookup = Bench::Measure(ops, [&](std::uint64_t i) {
+            int souls = static_cast<int>(i % 51);
+            auto multipliers = tables.For(souls);
+            if (const auto* rule = rules.Find(probes[i % probes.size()])) {
+                multipliers = rules.Apply(*rule, multipliers, souls);
+            }
+            Bench::DoNotOptimize(multipliers);
+        });
+
+        std::printf("%8u %10zu %12zu %12.1f %14.2f %12.2f\n", ruleCount, rules.GetShoutCount(),
+                    rules.GetMemoryFootprint(), compileNs / 1000.0, lookup.nsPerOp, lookup.allocationsPerOp);
+        steady &= Bench::ExpectNoAllocations("rule lookup", lookup);
+    }
+    return steady ? 0 : 1;
+}
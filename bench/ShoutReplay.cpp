@@ -0,0 +1,205 @@
+// Replays a shout event capture (bCaptureShoutEvents) against the scaling core and reports throughput, tail latency
+// and a fingerprint of the final form values, so two builds can be compared on the same session.
+//
+//   ShoutProgressionReplay <capture file> [--realtime] [--dump <values file>]
+//
+// --realtime  paces events by their captured timestamps instead of replaying back to back
+// --dump      writes every final form value, in load order, as raw floats for a byte-wise diff between builds
+//
+// Each shout FormID in the capture is mapped to a synthetic mock shout (three variations, 1-20 effects, shared
+// projectiles); the mapping depends only on the set of FormIDs, so every build replays against identical forms.
+// Player events apply the shout for the captured soul total and NPC events restore it, as ShoutHandler does.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "DefaultCurves.h"
+#include "MockForms.h"
+#include "TraceFormat.h"
+#include "core/ShoutPlan.h"
+
+namespace {
+    using Plan = Core::Plan<Mock::Forms>;
+
+    struct Latencies {
+        std::vector<std::uint64_t> samples;
+
+        void Report(const char* name) {
+            if (samples.empty()) {
+                std::printf("%-14s %10s\n", name, "-");
+                return;
+            }
+            std::sort(samples.begin(), samples.end());
+            auto at = [this](double quantile) {
+                auto index = static_cast<std::size_t>(quantile * static_cast<double>(samples.size() - 1));
+                return static_cast<unsigned long long>(samples[index]);
+            };
+            std::printf("%-14s %10zu events  p50 %6llu ns  p99 %6llu ns  p99.9 %6llu ns  max %8llu ns\n", name,
+                        samples.size(), at(0.5), at(0.99), at(0.999), static_cast<unsigned long long>(samples.back()));
+        }
+    };
+
+    // Visits every float the plan can write, in load order
+    template <class F>
+    void ForEachValue(const Mock::LoadOrder& loadOrder, F&& visit) {
+        for (const auto* shout : loadOrder.all) {
+            for (const auto& variation : shout->variations) {
+                visit(variation.recoveryTime);
+                for (const auto* effect : variation.spell->effects) {
+                    visit(effect->effectItem.magnitude);
+                    visit(static_cast<float>(effect->effectItem.duration));
+                    visit(static_cast<float>(effect->effectItem.area));
+                    if (const auto* projectile = effect->baseEffect->data.projectileBase) {
+                        visit(projectile->data.speed);
+                        visit(projectile->data.range);
+                    }
+                }
+            }
+        }
+    }
+
+    std::uint64_t Fingerprint(const Mock::LoadOrder& loadOrder) {
+        std::uint64_t hash = 0xCBF29CE484222325ull;  // FNV-1a over the raw bits
+        ForEachValue(loadOrder, [&hash](float value) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int i = 0; i < 4; i++) {
+                hash = (hash ^ ((bits >> (8 * i)) & 0xFF)) * 0x100000001B3ull;
+            }
+        });
+        return hash;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* capturePath = nullptr;
+    const char* dumpPath = nullptr;
+    bool realtime = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--realtime") == 0) {
+            realtime = true;
+        } else if (std::strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpPath = argv[++i];
+        } else {
+            capturePath = argv[i];
+        }
+    }
+    if (!capturePath) {
+        std::cerr << "usage: " << argv[0] << " <capture file> [--realtime] [--dump <values file>]\n";
+        return 1;
+    }
+
+    std::ifstream input(capturePath, std::ios::binary);
+    Trace::FileHeader header;
+    if (!input || !input.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "SPTR", 4) != 0 || header.recordSize != sizeof(Trace::Record)) {
+        std::cerr << capturePath << " is not a ShoutProgression capture\n";
+        return 1;
+    }
+
+    std::vector<Trace::Record> casts;
+    std::uint64_t dropped = 0;
+    Trace::Record record;
+    while (input.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        if (record.event == Trace::Event::kCast) {
+            casts.push_back(record);
+        } else if (record.event == Trace::Event::kDropped) {
+            dropped += record.u[0];
+        }
+    }
+    if (casts.empty()) {
+        std::cerr << "no shout events in " << capturePath << "\n";
+        return 1;
+    }
+
+    // Reconstruct one mock shout per captured FormID
+    std::vector<std::uint32_t> formIDs;
+    for (const auto& cast : casts) {
+        formIDs.push_back(cast.form);
+    }
+    std::sort(formIDs.begin(), formIDs.end());
+    formIDs.erase(std::unique(formIDs.begin(), formIDs.end()), formIDs.end());
+
+    Mock::LoadOrderSpec spec;
+    spec.shouts = static_cast<std::uint32_t>(formIDs.size());
+    spec.playerShouts = 0;
+    Mock::LoadOrder loadOrder(spec);
+
+    std::unordered_map<std::uint32_t, Mock::TESShout*> shouts;
+    for (std::size_t i = 0; i < formIDs.size(); i++) {
+        shouts.emplace(formIDs[i], loadOrder.all[i]);
+    }
+
+    Plan plan;
+    plan.Build(loadOrder.all);
+    Bench::DefaultCurves curves;
+
+    std::printf("Replaying %zu shout events over %zu shouts%s\n", casts.size(), formIDs.size(),
+                realtime ? " in real time" : "");
+    if (dropped != 0) {
+        std::printf("warning: the capture lost %llu records to buffer overflow\n",
+                    static_cast<unsigned long long>(dropped));
+    }
+
+    Latencies player;
+    Latencies npc;
+    player.samples.reserve(casts.size());
+    npc.samples.reserve(casts.size());
+
+    auto allocations = Bench::Allocations();
+    std::uint64_t busy = 0;
+    auto replayStart = std::chrono::steady_clock::now();
+    for (const auto& cast : casts) {
+        if (realtime) {
+            std::this_thread::sleep_until(replayStart + std::chrono::nanoseconds(cast.timestamp - casts[0].timestamp));
+        }
+
+        auto* shout = shouts[cast.form];
+        auto start = std::chrono::steady_clock::now();
+        if (cast.u[1] & Trace::CAST_PLAYER) {
+            int souls = static_cast<int>(cast.u[2] + cast.u[3]);
+            Bench::DoNotOptimize(plan.Apply(shout, curves.For(souls), Core::MakeStamp(1, souls)));
+        } else {
+            Bench::DoNotOptimize(plan.Restore(shout));
+        }
+        auto elapsed = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+        busy += elapsed;
+        ((cast.u[1] & Trace::CAST_PLAYER) ? player : npc).samples.push_back(elapsed);
+    }
+    allocations = Bench::Allocations() - allocations;
+
+    std::printf("Throughput: %.0f events/s of handler time, %.2f allocs/event\n",
+                static_cast<double>(casts.size()) * 1e9 / static_cast<double>(busy ? busy : 1),
+                static_cast<double>(allocations) / static_cast<double>(casts.size()));
+    player.Report("player apply");
+    npc.Report("NPC restore");
+
+    auto stats = plan.GetCacheStats();
+    std::printf("Applied-state cache: apply %llu hits / %llu misses, restore %llu hits / %llu misses\n",
+                static_cast<unsigned long long>(stats.applyHits), static_cast<unsigned long long>(stats.applyMisses),
+                static_cast<unsigned long long>(stats.restoreHits),
+                static_cast<unsigned long long>(stats.restoreMisses));
+    std::printf("Final form values fingerprint: %016llx\n", static_cast<unsigned long long>(Fingerprint(loadOrder)));
+
+    if (dumpPath) {
+        std::ofstream dump(dumpPath, std::ios::binary | std::ios::trunc);
+        ForEachValue(loadOrder,
+                     [&dump](float value) { dump.write(reinterpret_cast<const char*>(&value), sizeof(value)); });
+        if (!dump) {
+            std::cerr << "cannot write " << dumpPath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
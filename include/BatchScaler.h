@@ -0,0 +1,71 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ScalingPlan.h"
+
+struct Config;
+
+// Rescales every shout the player has as soon as the soul total can have changed (a dragon soul absorbed, a word
+// learned or unlocked, a configuration reload, a game load), so the cast itself finds its shout already applied and
+// only compares stamps.
+//
+// A request is handled in three steps:
+//  1. game thread (task): read the soul total and the player's shout list, stamp the job as the cast path would
+//  2. worker thread:      compute every record's scaled value from the plan snapshot, without touching the forms
+//  3. game thread (task): write the values and mark the shouts applied in one batch
+//
+// Requests that arrive while a job is in flight are merged, and a job overtaken by a newer request is dropped before
+// it is committed. A cast that beats the batch is scaled inline as before, so the batch is purely an optimization.
+class BatchScaler : public RE::BSTEventSink<RE::DragonSoulsGained::Event> {
+public:
+    static BatchScaler* GetSingleton();
+
+    // Sinks dragon soul events and starts the worker. Called once at kDataLoaded.
+    void Register();
+
+    // Requests a recompute. Safe from any thread.
+    void Schedule();
+
+    RE::BSEventNotifyControl ProcessEvent(const RE::DragonSoulsGained::Event* a_event,
+                                          RE::BSTEventSource<RE::DragonSoulsGained::Event>*) override;
+
+private:
+    BatchScaler() = default;
+    BatchScaler(const BatchScaler&) = delete;
+    BatchScaler(BatchScaler&&) = delete;
+    ~BatchScaler() override = default;
+
+    BatchScaler& operator=(const BatchScaler&) = delete;
+    BatchScaler& operator=(BatchScaler&&) = delete;
+
+    struct Job {
+        std::uint64_t request;
+        Core::TrackedVector<RE::TESShout*, Core::Subsystem::kBatch> shouts;
+        const Config* config;  // outlives the job: a config is only freed several reloads later
+        int totalSouls;
+        std::uint64_t stamp;
+        ScalingPlan::Batch batch;
+        std::uint64_t prepareNanoseconds;
+    };
+
+    void Gather();
+    void Run();
+    void Commit(std::unique_ptr<Job> job);
+
+    std::atomic<std::uint64_t> _requests{ 0 };
+    std::atomic<bool> _gatherQueued{ false };
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::unique_ptr<Job> _pending;  // gathered, waiting for the worker
+    std::unique_ptr<Job> _spare;    // a committed job, reused so steady-state jobs do not allocate
+};
@@ -1,23 +1,99 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 
+#include "Curves.h"
+#include "core/FlatFormMap.h"
+#include "core/ShoutRules.h"
+
+// Settings are published as immutable snapshots. Load() reads the INI into a fresh Config, bakes its curves and swaps
+// it in with one atomic store, so a reader that takes GetSingleton() once per event sees one consistent set of values
+// even while a reload runs on another thread.
 struct Config {
     float fDistanceMultiplier = 0.04f;
     float fMagnitudeMultiplier = 0.03f;
     float fCooldownReduction = 0.01f;
     int iMaxDragonSouls = 50;
     bool bCountSpentSouls = true;
+    bool bPerCastScaling = false;
+    bool bUseShoutHook = true;
 
     float fMinDistanceMultiplier = 1.0f;
     float fMinMagnitudeMultiplier = 1.0f;
     float fMinCooldownMultiplier = 0.2f;
 
+    // Progression curve types: 0 = linear, 1 = logarithmic, 2 = exponential decay, 3 = piecewise
+    int iDistanceCurve = 0;
+    int iMagnitudeCurve = 0;
+    int iCooldownCurve = 0;
+
+    // Value approached by exponential decay curves (the cooldown curve approaches fMinCooldownMultiplier)
+    float fDistanceCurveLimit = 3.0f;
+    float fMagnitudeCurveLimit = 2.5f;
+
+    // Breakpoints for piecewise curves, "souls:multiplier" pairs separated by commas
+    std::string sDistanceCurvePoints = "0:1.0, 50:3.0";
+    std::string sMagnitudeCurvePoints = "0:1.0, 50:2.5";
+    std::string sCooldownCurvePoints = "0:1.0, 50:0.5";
+
     bool bEnableDebugLogging = true;
+    int iDebugLogMode = 1;  // 0 = synchronous, 1 = asynchronous text, 2 = asynchronous binary trace
+
+    bool bEnableMetrics = false;
+    int iMetricsDumpInterval = 300;  // seconds, 0 = only on demand
+
+    bool bCaptureShoutEvents = false;  // ShoutProgression.capture, for bench/ShoutReplay
+
+    bool bBatchScaling = true;  // rescale every player shout when the soul total changes instead of at the cast
+
+    // NPC progression: actors listed in the rules file, and followers, scale their shouts by their own soul count
+    // instead of using vanilla values. Not used with bPerCastScaling.
+    bool bNPCProgression = false;
+    bool bFollowerProgression = true;
+    float fNPCSoulsPerLevel = 1.0f;  // souls of an actor whose progression follows its level
+
+    bool bUsePlanCache = true;  // SKSE/Plugins/ShoutProgression.plancache, rebuilt whenever the load order changes
+    int iPlanBuildThreads = 0;  // workers compiling the plan at data load, 0 = pick from load order size and cores
+
+    int iReloadPollInterval = 2;  // seconds between checks of the MCM settings file, 0 = reload only on request
+
+    // Unique per published snapshot. The scaling plan folds it into its applied-state stamps, so shouts applied under
+    // an older snapshot are rewritten on their next cast.
+    std::uint32_t generation = 0;
+
+    // Curves baked for soul counts 0..iMaxDragonSouls, rebuilt on every load
+    Curves::MultiplierTable distanceTable;
+    Curves::MultiplierTable magnitudeTable;
+    Curves::MultiplierTable cooldownTable;
+
+    // Per-shout overrides from ShoutProgression_Rules.ini, compiled on every load
+    Core::ShoutRules rules;
+    // Actor or base NPC FormID -> souls (RulesFile::ACTOR_SOULS_FROM_LEVEL for level-based), from the same file
+    Core::FlatFormMap<std::int32_t> actorSouls;
 
     Config();
 
-    static Config* GetSingleton();
-    void LoadFromINI();
+    // Current snapshot. Never null once Load() has run. Hold the pointer for one cast or one batch job at most: a
+    // snapshot is freed once several reloads have replaced it.
+    static const Config* GetSingleton();
+
+    // Reads the INI, bakes the curves and publishes the result. Game thread only: the rules file looks forms up.
+    // bPerCastScaling, bUseShoutHook, iDebugLogMode and bCaptureShoutEvents pick which hooks and threads are set up at
+    // data load, so reloads keep their first values.
+    static const Config* Load();
+
+    // Queues Load() on the game thread through the SKSE task interface. Safe from any thread; requests made while one
+    // is queued are folded into it.
+    static void RequestReload();
+
+    // Polls the settings file on a background thread and requests a reload once a change has settled
+    static void StartWatching();
+
+private:
+    void ReadINI(const std::string& path);
+    void BakeCurves();
+    void LogSettings() const;
 };
 
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/MemoryAccounting.h"
+
+// Progression curves: soul count -> multiplier.
+//
+// Every curve starts at `base` with an initial per-soul slope of `rate`, so switching the curve type keeps the early
+// game feeling the same and only changes how the curve behaves later on:
+//   linear       base + rate * souls
+//   logarithmic  base + rate * ln(1 + souls)
+//   exponential  limit + (base - limit) * exp(-k * souls), approaching `limit`, with k chosen so the slope at 0 is `rate`
+//   piecewise    linear interpolation between (souls, multiplier) breakpoints, flat past the first and last point
+// The result is clamped to [min, max].
+namespace Curves {
+    enum class Type : std::uint8_t {
+        kLinear,
+        kLogarithmic,
+        kExponentialDecay,
+        kPiecewise
+    };
+
+    struct Curve {
+        Type type = Type::kLinear;
+        float base = 1.0f;
+        float rate = 0.0f;
+        float limit = 1.0f;
+        float min = -1.0e30f;
+        float max = 1.0e30f;
+        std::vector<std::pair<float, float>> points;  // sorted by souls
+
+        float Evaluate(int souls) const;
+    };
+
+    const char* TypeName(Type type);
+
+    // Parses "souls:multiplier" pairs separated by commas, e.g. "0:1.0, 10:1.4, 50:2.0". Malformed pairs are skipped.
+    std::vector<std::pair<float, float>> ParsePoints(std::string_view text);
+
+    // A curve baked into a dense table indexed by soul count 0..maxSouls. Soul counts outside the range are clamped.
+    // Ranges too large for a table fall back to evaluating the curve on each lookup.
+    class MultiplierTable {
+    public:
+        static constexpr int MAX_TABLE_SIZE = 4096;
+
+        void Bake(const Curve& curve, int maxSouls);
+
+        float Lookup(int souls) const {
+            souls = souls < 0 ? 0 : (souls > _maxSouls ? _maxSouls : souls);
+            return _values.empty() ? _curve.Evaluate(souls) : _values[static_cast<std::size_t>(souls)];
+        }
+
+        bool IsTabulated() const { return !_values.empty(); }
+        const Curve& GetCurve() const { return _curve; }
+        std::size_t GetMemoryFootprint() const { return _values.capacity() * sizeof(float); }
+
+    private:
+        Curve _curve;
+        Core::TrackedVector<float, Core::Subsystem::kCurves> _values;
+        int _maxSouls = 0;
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <iterator>
+
+#include "core/Archetypes.h"
+#include "core/PlanCache.h"
+
+// Binds the form-independent core (include/core) to CommonLib's forms
+struct GameForms {
+    using Shout = RE::TESShout;
+    using Spell = RE::MagicItem;
+
+    static std::uint32_t GetArchetype(RE::EffectSetting* effect) {
+        return static_cast<std::uint32_t>(effect->GetArchetype());
+    }
+
+    static bool IsWordKnown(RE::TESWordOfPower* word) { return word->GetKnown(); }
+
+    template <class T>
+    static std::uint32_t GetFormID(const T* form) {
+        return form->GetFormID();
+    }
+
+    static Shout* LookupShout(std::uint32_t formID) { return RE::TESForm::LookupByID<RE::TESShout>(formID); }
+
+    static void* Resolve(const Core::RecordKey& key) {
+        switch (key.field) {
+            case Core::Field::kRecoveryTime: {
+                auto* shout = RE::TESForm::LookupByID<RE::TESShout>(key.owner);
+                return shout && key.index < std::size(shout->variations) ? &shout->variations[key.index].recoveryTime
+                                                                         : nullptr;
+            }
+            case Core::Field::kMagnitude:
+            case Core::Field::kDuration:
+            case Core::Field::kArea: {
+                auto* spell = RE::TESForm::LookupByID<RE::SpellItem>(key.owner);
+                if (!spell || key.index >= spell->effects.size() || !spell->effects[key.index]) {
+                    return nullptr;
+                }
+                auto& item = spell->effects[key.index]->effectItem;
+                return key.field == Core::Field::kMagnitude ? static_cast<void*>(&item.magnitude)
+                       : key.field == Core::Field::kDuration ? static_cast<void*>(&item.duration)
+                                                             : static_cast<void*>(&item.area);
+            }
+            case Core::Field::kProjectileSpeed:
+            case Core::Field::kProjectileRange: {
+                auto* projectile = RE::TESForm::LookupByID<RE::BGSProjectile>(key.owner);
+                if (!projectile) {
+                    return nullptr;
+                }
+                return key.field == Core::Field::kProjectileSpeed ? &projectile->data.speed : &projectile->data.range;
+            }
+        }
+        return nullptr;
+    }
+};
+
+static_assert(static_cast<std::uint32_t>(RE::EffectArchetypes::ArchetypeID::kValueModifier) ==
+              static_cast<std::uint32_t>(Core::Archetype::kValueModifier));
+static_assert(static_cast<std::uint32_t>(RE::EffectArchetypes::ArchetypeID::kSlowTime) ==
+              static_cast<std::uint32_t>(Core::Archetype::kSlowTime));
+static_assert(static_cast<std::uint32_t>(RE::EffectArchetypes::ArchetypeID::kVampireLord) ==
+              static_cast<std::uint32_t>(Core::Archetype::kVampireLord));
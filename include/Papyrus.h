@@ -0,0 +1,8 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+// Native functions of the ShoutProgression Papyrus script (Scripts/Source/ShoutProgression.psc)
+namespace Papyrus {
+    bool Register(RE::BSScript::IVirtualMachine* vm);
+}
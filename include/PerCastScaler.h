@@ -0,0 +1,83 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "ScalingPlan.h"
+
+// Per-cast scaling (bPerCastScaling): the player's shouts are scaled on the objects a cast creates instead of on the
+// shared TESShout/SpellItem/BGSProjectile forms, so NPC shouts never see scaled values and nothing has to be restored.
+//
+// The multipliers of each cast are kept per shooter, so every projectile and effect is scaled for the cast of the
+// actor that launched it, and a projectile keeps the multipliers it launched with.
+//
+//  - cooldown:   the player's voice recovery timer is scaled once the shout has fired
+//  - magnitude:  MagicTarget::AddTarget is hooked and the magnitude of effects the player's shout applies is scaled
+//                as the archetype table says
+//  - duration:   the active effect AddTarget creates has its duration scaled like the shared-form mode scales the
+//                effect's (magnitude multiplier)
+//  - distance:   projectile UpdateImpl is hooked and the first update of a player shout projectile scales its
+//                velocity and range
+//
+// Areas are not scaled in this mode: the engine reads them from the shared effect when it picks the targets of an
+// impact, before any per-cast object exists. Scaled areas need the shared-form mode; the first unscaled one is logged.
+class PerCastScaler {
+public:
+    static PerCastScaler* GetSingleton();
+
+    // Installs the hooks. Called once at kDataLoaded when per-cast mode is enabled.
+    void Install();
+
+    // Called when the player's shout fires, with the multipliers for the current soul total
+    void OnPlayerShoutFired(RE::PlayerCharacter* player, const ScalingPlan::Multipliers& multipliers);
+
+    bool IsInstalled() const { return _installed; }
+
+private:
+    PerCastScaler() = default;
+    PerCastScaler(const PerCastScaler&) = delete;
+    PerCastScaler(PerCastScaler&&) = delete;
+    ~PerCastScaler() = default;
+
+    PerCastScaler& operator=(const PerCastScaler&) = delete;
+    PerCastScaler& operator=(PerCastScaler&&) = delete;
+
+    static bool IsPlayerShout(const RE::TESObjectREFR* caster, const RE::MagicItem* item);
+
+    void ScaleTargetData(RE::MagicTarget::AddTargetData& data);
+    void ScaleActiveEffect(RE::MagicTarget* target, const RE::MagicTarget::AddTargetData& data);
+    void ScaleProjectile(RE::Projectile* projectile);
+
+    template <class T>
+    friend struct AddTargetHook;
+    template <class T>
+    friend struct ProjectileUpdateHook;
+
+    // Multipliers of a shooter's last cast, and of every player shout projectile already scaled (so later updates of
+    // it are left alone), both by native reference handle. Handles carry an age, so a recycled handle never matches
+    // a dead projectile's entry. Dead entries are dropped once the maps grow past PRUNE_SIZE. Projectiles update on
+    // several threads, so the maps are locked.
+    struct Scaled {
+        RE::ObjectRefHandle handle;
+        ScalingPlan::Multipliers multipliers;
+    };
+
+    // The shooter's multipliers; false when it has no cast recorded
+    bool FindCast(RE::ObjectRefHandle shooter, ScalingPlan::Multipliers& multipliers);
+    // Records the projectile's multipliers from its shooter's cast; false when it already was, or has no cast
+    bool MarkScaled(RE::ObjectRefHandle projectile, RE::ObjectRefHandle shooter, ScalingPlan::Multipliers& multipliers);
+    static void Prune(std::unordered_map<std::uint32_t, Scaled>& scaled);
+
+    static constexpr std::size_t PRUNE_SIZE = 64;
+    std::mutex _lock;
+    std::unordered_map<std::uint32_t, Scaled> _casts;
+    std::unordered_map<std::uint32_t, Scaled> _projectiles;
+    std::atomic<bool> _areaLogged{ false };
+
+    bool _installed = false;
+};
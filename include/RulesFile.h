@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/FlatFormMap.h"
+#include "core/ShoutRules.h"
+
+// Per-shout override rules from Data/SKSE/Plugins/ShoutProgression_Rules.ini, one INI section per rule:
+//
+//   [Clear Skies]
+//   Shout = Skyrim.esm|3CD5E          ; plugin + local FormID (hex); repeatable
+//   EditorID = ClearSkiesShout        ; needs a mod that keeps editor IDs loaded; repeatable
+//   Archetype = Etherealize           ; any shout with an effect of this archetype; repeatable
+//   bScaleDistance = false            ; per multiplier (Distance, Magnitude, Cooldown):
+//   fMinCooldown = 0.6                ;   bScale<M>, fMin<M>, fMax<M>, s<M>CurvePoints
+//
+// and the NPCs whose shouts progress when bNPCProgression is on, one section per group of actors:
+//
+//   [Companions]
+//   Actor = MyFollower.esp|D62        ; actor reference or base NPC (plugin + local FormID); repeatable
+//   iSouls = 30                       ; fixed soul count; omitted = derived from the actor's level
+//
+// Read as part of every configuration load, so rules reload with the MCM settings.
+namespace RulesFile {
+    // Soul count of actors whose progression follows their level
+    inline constexpr std::int32_t ACTOR_SOULS_FROM_LEVEL = -1;
+
+    // A missing file means no rules. Selectors that resolve to nothing are logged and skipped. `actorSouls` maps actor
+    // and base NPC FormIDs to a soul count or ACTOR_SOULS_FROM_LEVEL; the first section naming an actor wins.
+    void Load(int maxSouls, Core::ShoutRules& rules, Core::FlatFormMap<std::int32_t>& actorSouls);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "GameForms.h"
+#include "core/ShoutPlan.h"
+
+// Flattened, precompiled scaling data for every TESShout.
+//
+// Each shout is compiled once into a contiguous run of records holding the address to write, the value captured
+// before any scaling, and the transform to apply. Applying or restoring a shout is then a single linear pass over
+// that run: no hashing, no allocation and no pointer chasing through spells, effects and projectiles.
+//
+// The compiled data is an immutable snapshot published once at kDataLoaded, so the cast and restore paths read it
+// without taking any lock. A shout that appears later is compiled into a copy that is swapped in atomically.
+//
+// Each shout also remembers what its forms currently hold (scaled for a given soul total and config generation, or
+// restored), so repeated applies and restores with nothing changed are skipped. Targets written by several shouts
+// (shared projectiles) remember which multiplier they were last written with, so a shout whose shared projectile was
+// rewritten for another shout's values (an NPC's souls, a per-shout rule) is written again.
+//
+// The plan itself lives in Core::Plan (include/core/ShoutPlan.h) so it can be built and benchmarked off the game;
+// this class adds the data handler, logging, tracing and metrics.
+class ScalingPlan {
+public:
+    using Transform = Core::Transform;
+    using Record = Core::Record;
+    using Multipliers = Core::Multipliers;
+    using CacheStats = Core::CacheStats;
+    using Batch = Core::Plan<GameForms>::Batch;
+    using Target = Core::Plan<GameForms>::Target;
+    using ReconcileStats = Core::Plan<GameForms>::ReconcileStats;
+
+    static constexpr std::uint64_t MakeStamp(std::uint32_t configGeneration, int totalSouls) {
+        return Core::MakeStamp(configGeneration, totalSouls);
+    }
+
+    static constexpr std::uint64_t MakeNPCStamp(std::uint32_t configGeneration, int souls) {
+        return Core::MakeNPCStamp(configGeneration, souls);
+    }
+
+    static ScalingPlan* GetSingleton();
+
+    // Compiles every TESShout known to the data handler, or loads the plan from the on-disk cache when the load order
+    // is unchanged (bUsePlanCache). Compiling is spread over iPlanBuildThreads workers. Must run at kDataLoaded, before
+    // any shout is scaled.
+    void Build();
+
+    // Both return the number of records written, 0 when the forms already hold the requested values. Shouts that
+    // were not present at build time are compiled on first use.
+    std::uint32_t Apply(RE::TESShout* shout, const Multipliers& multipliers, std::uint64_t stamp);
+    std::uint32_t Restore(RE::TESShout* shout);
+
+    // Computes every record of `shouts` without writing the forms; safe on any thread. `multipliersFor(shout)` gives
+    // each shout's multipliers.
+    template <class Range, class F>
+    void Prepare(const Range& shouts, F&& multipliersFor, std::uint64_t stamp, Batch& batch) const {
+        _plan.Prepare(shouts, std::forward<F>(multipliersFor), stamp, batch);
+    }
+
+    // Writes a prepared batch on the game thread. Returns the number of records written.
+    std::uint32_t Commit(const Batch& batch);
+
+    // The shout a voice spell belongs to, or nullptr. Only shouts compiled into the plan are known.
+    RE::TESShout* FindShoutBySpell(const RE::MagicItem* spell) const;
+
+    // Calls visit(shout, stamp) for every shout whose forms hold scaled values
+    template <class F>
+    void ForEachApplied(F&& visit) const {
+        _plan.ForEachApplied(std::forward<F>(visit));
+    }
+
+    // Scales `targets` for their souls and restores every other shout, writing only what differs. Game thread only.
+    template <class F>
+    ReconcileStats Reconcile(std::span<Target> targets, std::uint32_t configGeneration, F&& multipliersFor) {
+        return _plan.Reconcile(targets, configGeneration, std::forward<F>(multipliersFor));
+    }
+
+    std::size_t GetMemoryFootprint() const;
+    CacheStats GetCacheStats() const;
+
+private:
+    using Plan = Core::Plan<GameForms>;
+
+    ScalingPlan() = default;
+    ScalingPlan(const ScalingPlan&) = delete;
+    ScalingPlan(ScalingPlan&&) = delete;
+    ~ScalingPlan() = default;
+
+    ScalingPlan& operator=(const ScalingPlan&) = delete;
+    ScalingPlan& operator=(ScalingPlan&&) = delete;
+
+    void OnWrite(RE::TESShout* shout, const Plan::Write& write);
+
+    Plan _plan;
+};
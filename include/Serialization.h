@@ -0,0 +1,68 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+#include <cstdint>
+
+#include "ScalingPlan.h"
+#include "core/MemoryAccounting.h"
+
+// Records in the SKSE co-save what the shared shout forms hold, and brings them back to it on load.
+//
+// Scaling writes into the forms, which outlive a save: loading another save in the same session keeps the values the
+// previous character left behind. The co-save stores one compact record (the player's soul total, the config
+// generation, and the FormID and soul count of every scaled shout), and loading it reconciles the forms in one pass:
+// shouts the save had scaled are rescaled only if they hold other values, and shouts it had vanilla are restored
+// only if they are scaled. Saves without the record (new games, saves from before the plugin) restore every scaled
+// shout once the game has loaded.
+//
+// Originals are never re-read from the forms here: they come from the scaling plan, captured at data load before
+// anything is scaled, so reconciling can never mistake a scaled value for an original.
+class Serialization {
+public:
+    static Serialization* GetSingleton();
+
+    // Registers the co-save callbacks. Must run from SKSEPluginLoad.
+    void Register();
+
+    // kPostLoadGame / kNewGame: restores everything scaled when the save had no record
+    void OnGameLoaded();
+
+private:
+    Serialization() = default;
+    Serialization(const Serialization&) = delete;
+    Serialization(Serialization&&) = delete;
+    ~Serialization() = default;
+
+    Serialization& operator=(const Serialization&) = delete;
+    Serialization& operator=(Serialization&&) = delete;
+
+    static constexpr std::uint32_t UNIQUE_ID = 'SHPR';
+    static constexpr std::uint32_t APPLIED_RECORD = 'APST';
+    static constexpr std::uint32_t APPLIED_VERSION = 1;
+
+    struct AppliedHeader {
+        std::uint32_t totalSouls;  // the player's, when saved
+        std::uint32_t generation;  // config generation, only meaningful within one session
+        std::uint32_t count;       // AppliedShout entries that follow
+    };
+
+    struct AppliedShout {
+        std::uint32_t formID;
+        std::uint32_t souls;
+    };
+
+    static void OnSave(SKSE::SerializationInterface* serialization);
+    static void OnLoad(SKSE::SerializationInterface* serialization);
+    static void OnRevert(SKSE::SerializationInterface* serialization);
+
+    bool ReadApplied(SKSE::SerializationInterface* serialization, std::uint32_t length);
+    void Reconcile(const char* source);
+
+    // Reused across saves and loads, so neither allocates once they have grown to the number of scaled shouts
+    Core::TrackedVector<AppliedShout, Core::Subsystem::kCoSave> _saved;
+    Core::TrackedVector<ScalingPlan::Target, Core::Subsystem::kCoSave> _targets;
+
+    bool _loaded = false;  // a record was read since the last revert
+};
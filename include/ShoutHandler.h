@@ -3,12 +3,37 @@
 #include <RE/Skyrim.h>
 #include <SKSE/SKSE.h>
 
+#include <atomic>
+#include <cstdint>
+
+#include "ScalingPlan.h"
+#include "core/ActorCache.h"
+
+struct Config;
+
 class ShoutHandler : public RE::BSTEventSink<SKSE::ActionEvent> {
 public:
     static ShoutHandler* GetSingleton();
 
+    // Hooks ActorMagicCaster::SpellCast so only voice spells reach the handler, instead of sinking every action
+    // event (weapon swings, bow draws, spell casts...) of every loaded actor.
+    static void InstallHook();
+
     RE::BSEventNotifyControl ProcessEvent(const SKSE::ActionEvent* a_event, RE::BSTEventSource<SKSE::ActionEvent>*) override;
 
+    // Common entry point for the hook and the action event sink. `fired` is false for kVoiceCast (shout started).
+    void OnShoutCast(RE::Actor* actor, RE::TESShout* shout, bool fired);
+
+    struct Souls {
+        int unspent;
+        int spent;
+    };
+
+    // Shared with BatchScaler, so batches are stamped exactly as the cast path would stamp them
+    Souls ReadSouls(RE::PlayerCharacter* player, const Config* config);
+    // The global curves, overridden by the shout's rule if it has one. Reads only `config`, so any thread may call it.
+    ScalingPlan::Multipliers GetMultipliers(const Config* config, const RE::TESShout* shout, int totalSouls);
+
 private:
     ShoutHandler() = default;
     ShoutHandler(const ShoutHandler&) = delete;
@@ -19,14 +44,25 @@ private:
     ShoutHandler& operator=(ShoutHandler&&) = delete;
 
     // Helper methods
-    void StoreOriginalShoutData(RE::TESShout* shout);
     void RestoreNPCShoutValues(RE::TESShout* shout);
-    void ApplyShoutScaling(RE::TESShout* shout, int totalSouls);
+    void ApplyNPCShoutScaling(RE::Actor* actor, RE::TESShout* shout, int souls, const Config* config);
+    void ApplyShoutScaling(RE::TESShout* shout, int totalSouls, const Config* config);
 
-    float CalculateDistanceMultiplier(int dragonSouls);
-    float CalculateMagnitudeMultiplier(int dragonSouls);
-    float CalculateCooldownMultiplier(int dragonSouls);
+    float CalculateDistanceMultiplier(const Config* config, int dragonSouls);
+    float CalculateMagnitudeMultiplier(const Config* config, int dragonSouls);
+    float CalculateCooldownMultiplier(const Config* config, int dragonSouls);
     int CountUnlockedShoutWords(RE::PlayerCharacter* player);
+
+    // Souls an NPC's shouts scale for under bNPCProgression, or -1 when they stay vanilla
+    int ReadActorSouls(RE::Actor* actor, const Config* config);
+    Core::ActorProgression ResolveProgression(RE::Actor* actor, const Config* config);
+    void LogCacheStats();
+
+    std::atomic<std::uint64_t> _eventsSinceStats{ 0 };  // counted from the sink and the hook
+
+    // Actors that cast shouts recently; big battles stay well under this, and anything past it just resolves again
+    static constexpr std::size_t ACTOR_CACHE_SIZE = 512;
+    Core::ActorCache _actorCache{ ACTOR_CACHE_SIZE };
 };
 
 
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Metrics.h"
+
+// Single-writer/many-reader publication of immutable state (read-copy-update).
+//
+// Readers get a raw pointer with one acquire load and never block. Writers build a new object off to the side and
+// swap it in. Replaced objects are retired rather than freed, because readers hold raw pointers without reference
+// counts. The plan publishes only at load and for late forms, so its retired list stays small for a session; owners
+// that publish on every settings change call Reclaim to bound theirs.
+template <class T>
+class Published {
+public:
+    const T* Load() const { return _current.load(std::memory_order_acquire); }
+
+    const T* Publish(std::unique_ptr<T> next) {
+        std::lock_guard<std::mutex> lock(_writerLock);
+        return PublishLocked(std::move(next));
+    }
+
+    // Copies the current object, lets `mutate` edit the copy and publishes it. `mutate` returns false to keep the
+    // current object (e.g. another writer already made the change).
+    template <class F>
+    const T* Update(F&& mutate) {
+        std::unique_lock<std::mutex> lock(_writerLock, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            SP_METRICS_ADD(kLockWaits, 1);
+            lock.lock();
+        }
+        auto* current = _current.load(std::memory_order_acquire);
+        auto next = current ? std::make_unique<T>(*current) : std::make_unique<T>();
+        if (!mutate(*next)) {
+            return current;
+        }
+        return PublishLocked(std::move(next));
+    }
+
+    // Frees all but the `keep` most recently retired objects (the current one is never freed). Only safe when no
+    // reader can still hold a pointer to an object that many publications old; the caller's readers must bound how
+    // long they keep one.
+    void Reclaim(std::size_t keep) {
+        std::lock_guard<std::mutex> lock(_writerLock);
+        auto retired = _retired.empty() ? 0 : _retired.size() - 1;  // the back is current
+        if (retired > keep) {
+            _retired.erase(_retired.begin(), _retired.begin() + static_cast<std::ptrdiff_t>(retired - keep));
+        }
+    }
+
+private:
+    const T* PublishLocked(std::unique_ptr<T> next) {
+        const T* raw = next.get();
+        _retired.push_back(std::move(next));
+        _current.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+    std::atomic<const T*> _current{ nullptr };
+    std::vector<std::unique_ptr<T>> _retired;
+    std::mutex _writerLock;
+};
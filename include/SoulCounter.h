@@ -0,0 +1,46 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+#include <cstdint>
+
+#include "core/SpentSouls.h"
+
+// Cached count of the words known for shouts the player has (the "spent souls" of bCountSpentSouls).
+//
+// The count is seeded on game load and only recomputed when the engine reports a word learned/unlocked or the
+// player's shout list changes (Core::HashShoutList), and the recount walks only the player's own shout list. Reading
+// it from the cast path hashes that short list, instead of scanning every TESShout in the load order.
+class SoulCounter : public RE::BSTEventSink<RE::WordLearned::Event>,
+                    public RE::BSTEventSink<RE::WordUnlocked::Event> {
+public:
+    static SoulCounter* GetSingleton();
+
+    void Register();
+    void Reseed();
+
+    int GetSpentSouls(RE::PlayerCharacter* player);
+
+    // Reference implementation: every TESShout in the data handler. Only used to cross-check the cache.
+    static int CountFullScan(RE::PlayerCharacter* player);
+
+    RE::BSEventNotifyControl ProcessEvent(const RE::WordLearned::Event* a_event,
+                                          RE::BSTEventSource<RE::WordLearned::Event>*) override;
+    RE::BSEventNotifyControl ProcessEvent(const RE::WordUnlocked::Event* a_event,
+                                          RE::BSTEventSource<RE::WordUnlocked::Event>*) override;
+
+private:
+    SoulCounter() = default;
+    SoulCounter(const SoulCounter&) = delete;
+    SoulCounter(SoulCounter&&) = delete;
+    ~SoulCounter() override = default;
+
+    SoulCounter& operator=(const SoulCounter&) = delete;
+    SoulCounter& operator=(SoulCounter&&) = delete;
+
+    static std::uint64_t HashPlayerShouts(RE::PlayerCharacter* player);
+    static int CountPlayerShouts(RE::PlayerCharacter* player);
+
+    Core::SpentSoulCache _cache;
+};
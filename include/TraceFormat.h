@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+// Fixed-size binary trace records shared by the in-game logger and the offline decoder (tools/TraceDecode.cpp).
+// Nothing here depends on CommonLib, so the decoder builds on any host.
+namespace Trace {
+    enum class Event : std::uint16_t {
+        kShoutDetected,     // form = shout, f[0..2] = distance, magnitude, cooldown multipliers
+        kSouls,             // u[0..2] = unspent, spent, total souls
+        kRecordWritten,     // form = shout, u[0] = record index, u[1] = transform, f[2] = original, f[3] = new
+        kRecordsTotal,      // form = shout, u[0] = records written (0 when already scaled)
+        kNPCRestore,        // form = shout, u[0] = records written (0 when already vanilla)
+        kVoiceTimer,        // f[0] = original, f[1] = scaled recovery timer
+        kTargetMagnitude,   // form = magic effect, f[0] = original, f[1] = scaled magnitude
+        kProjectileScaled,  // form = projectile reference, f[0] = distance multiplier
+        kCacheStats,        // u[0..3] = apply hits, apply misses, restore hits, restore misses
+        kSoulDrift,         // u[0] = recount of the player's shout list, u[1] = full scan
+        kDropped,           // u[0] = records dropped since the previous kDropped
+        kCast,              // form = shout, u[0] = actor, u[1] = CAST_* flags, u[2..3] = unspent, spent souls (player)
+        kNPCScaled,         // form = shout, u[0] = actor, u[1] = souls, u[2] = records written (bNPCProgression)
+        kTargetDuration,    // form = magic effect, f[0] = original, f[1] = scaled duration of the active effect
+        kCount
+    };
+
+    struct Record {
+        std::uint64_t timestamp;  // steady clock, nanoseconds
+        Event event;
+        std::uint16_t reserved;
+        std::uint32_t form;
+        union {
+            float f[4];
+            std::uint32_t u[4];
+        };
+    };
+    static_assert(sizeof(Record) == 32);
+
+    // kCast flags
+    inline constexpr std::uint32_t CAST_PLAYER = 1;
+    inline constexpr std::uint32_t CAST_FIRED = 2;  // kVoiceFire / spell cast, as opposed to kVoiceCast
+
+    struct FileHeader {
+        char magic[4] = { 'S', 'P', 'T', 'R' };
+        std::uint16_t version = 1;
+        std::uint16_t recordSize = sizeof(Record);
+        std::uint64_t startTimestamp = 0;
+    };
+    static_assert(sizeof(FileHeader) == 16);
+
+    // Values of ScalingPlan::Transform
+    inline const char* TransformName(std::uint32_t transform) {
+        switch (transform) {
+            case 0:
+                return "cooldown";
+            case 1:
+                return "magnitude";
+            case 2:
+                return "magnitude (SlowTime - inverted)";
+            case 3:
+                return "distance";
+            case 4:
+                return "duration";
+            case 5:
+                return "area";
+        }
+        return "unknown";
+    }
+
+    // A formatted line held inline, so logging a record synchronously on the cast path does not allocate
+    struct Line {
+        char text[256];
+        std::size_t length;
+
+        std::string_view View() const { return { text, length }; }
+    };
+
+    // snprintf rather than std::format so the decoder builds with any host standard library
+    template <class... Args>
+    Line Printf(const char* format, Args... args) {
+        Line line;
+        int length = std::snprintf(line.text, sizeof(line.text), format, args...);
+        line.length = length < 0 ? 0 : std::min<std::size_t>(static_cast<std::size_t>(length), sizeof(line.text) - 1);
+        return line;
+    }
+
+    inline Line Format(const Record& record) {
+        switch (record.event) {
+            case Event::kShoutDetected:
+                return Printf("Player shout detected: %08X (distance x%g, magnitude x%g, cooldown x%g)", record.form,
+                              record.f[0], record.f[1], record.f[2]);
+            case Event::kSouls:
+                return Printf("  Souls: %u unspent + %u spent = %u", record.u[0], record.u[1], record.u[2]);
+            case Event::kRecordWritten:
+                return Printf("  Record #%u (%s): %g -> %g", record.u[0], TransformName(record.u[1]), record.f[2],
+                              record.f[3]);
+            case Event::kRecordsTotal:
+                return record.u[0] == 0 ? Printf("  Shout %08X already scaled for this soul total", record.form)
+                                        : Printf("  Total records written for %08X: %u", record.form, record.u[0]);
+            case Event::kNPCRestore:
+                return Printf("NPC shout %08X: %u records restored", record.form, record.u[0]);
+            case Event::kVoiceTimer:
+                return Printf("  Voice recovery timer: %g -> %g", record.f[0], record.f[1]);
+            case Event::kTargetMagnitude:
+                return Printf("  Effect %08X on target: mag %g -> %g", record.form, record.f[0], record.f[1]);
+            case Event::kProjectileScaled:
+                return Printf("  Projectile %08X: velocity and range x%g", record.form, record.f[0]);
+            case Event::kCacheStats:
+                return Printf("Applied-state cache: apply %u hits / %u misses, restore %u hits / %u misses",
+                              record.u[0], record.u[1], record.u[2], record.u[3]);
+            case Event::kSoulDrift:
+                return Printf("Spent soul counter drifted: recounted %u, full scan %u", record.u[0], record.u[1]);
+            case Event::kDropped:
+                return Printf("Trace buffer overflow: %u records dropped", record.u[0]);
+            case Event::kCast:
+                return Printf("%s %s %08X by %08X (souls %u + %u)", (record.u[1] & CAST_PLAYER) ? "Player" : "NPC",
+                              (record.u[1] & CAST_FIRED) ? "fired" : "started", record.form, record.u[0], record.u[2],
+                              record.u[3]);
+            case Event::kNPCScaled:
+                return Printf("NPC %08X shout %08X scaled for %u souls: %u records written", record.u[0], record.form,
+                              record.u[1], record.u[2]);
+            case Event::kTargetDuration:
+                return Printf("  Effect %08X on target: duration %g -> %g", record.form, record.f[0], record.f[1]);
+            case Event::kCount:
+                break;
+        }
+        return Printf("Unknown trace event %u", static_cast<unsigned>(record.event));
+    }
+}
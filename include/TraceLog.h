@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+#include "TraceFormat.h"
+#include "core/MemoryAccounting.h"
+
+// Debug logging for the shout hot path.
+//
+// In synchronous mode (iDebugLogMode = 0) records are formatted and logged immediately, as before. In the
+// asynchronous modes the game thread only copies a 32-byte record into a lock-free ring buffer; a background thread
+// drains it in batches and either formats it into the text log (1) or appends it to a compact binary file that
+// tools/TraceDecode.cpp turns back into text (2). When the ring is full, records are dropped and counted.
+//
+// Independently of the mode, bCaptureShoutEvents sends one kCast record per shout event through the same ring into
+// ShoutProgression.capture, an append-only stream of trace records that bench/ShoutReplay.cpp replays offline.
+class TraceLog {
+public:
+    enum class Mode : std::uint8_t {
+        kSynchronous,
+        kAsyncText,
+        kAsyncBinary
+    };
+
+    static TraceLog* GetSingleton();
+
+    // Starts the background writer for the asynchronous modes or for capturing. The binary and capture files are
+    // written next to the text log.
+    void Start(Mode mode, const std::filesystem::path& logDirectory, bool capture = false);
+    void Stop();
+
+    void Write(Trace::Event event, std::uint32_t form, float f0 = 0.0f, float f1 = 0.0f, float f2 = 0.0f,
+               float f3 = 0.0f);
+    void WriteUInt(Trace::Event event, std::uint32_t form, std::uint32_t u0 = 0, std::uint32_t u1 = 0,
+                   std::uint32_t u2 = 0, std::uint32_t u3 = 0);
+
+    // Capture record for one shout event; a no-op unless capturing
+    void WriteCast(std::uint32_t actor, std::uint32_t shout, bool player, bool fired, std::uint32_t unspentSouls,
+                   std::uint32_t spentSouls);
+    bool IsCapturing() const { return _capturing.load(std::memory_order_relaxed); }
+
+    std::uint64_t GetDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t CAPACITY = 4096;  // power of two
+    static constexpr std::size_t BATCH_SIZE = 256;
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence;
+        Trace::Record record;
+    };
+
+    TraceLog();
+    TraceLog(const TraceLog&) = delete;
+    TraceLog(TraceLog&&) = delete;
+    ~TraceLog();
+
+    TraceLog& operator=(const TraceLog&) = delete;
+    TraceLog& operator=(TraceLog&&) = delete;
+
+    static std::uint64_t Now() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    void Submit(const Trace::Record& record);
+    bool TryPush(const Trace::Record& record);
+    bool TryPop(Trace::Record& record);
+    void Run(std::stop_token stop, std::filesystem::path binaryPath, std::filesystem::path capturePath);
+
+    Core::TrackedVector<Slot, Core::Subsystem::kTrace> _slots;
+    alignas(64) std::atomic<std::uint64_t> _head{ 0 };
+    alignas(64) std::uint64_t _tail = 0;  // consumer only
+    alignas(64) std::atomic<std::uint64_t> _dropped{ 0 };
+
+    std::atomic<Mode> _mode{ Mode::kSynchronous };
+    std::atomic<bool> _capturing{ false };
+    std::jthread _writer;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <thread>
+
+#include "MemoryAccounting.h"
+
+// How NPC shouts progress, resolved once per actor and kept in a bounded cache keyed by actor reference FormID.
+//
+// The cache is set-associative: an actor hashes to one set of WAYS slots, so a lookup compares at most WAYS keys that
+// share a cache line, and inserting into a full set evicts its least recently used slot. Actors that unload stop
+// casting, so they age out of their set without being tracked. All storage is allocated by the constructor.
+//
+// Every set has its own spin lock, held only while its keys are scanned or one slot is written, so casts on different
+// threads rarely meet and never wait on a cache-wide lock. Entries remember the config generation they were resolved
+// under, and a reload makes them miss.
+namespace Core {
+    struct ActorProgression {
+        enum class Source : std::uint8_t {
+            kNone,     // vanilla values
+            kFixed,    // `souls`
+            kLevel,    // derived from the actor's level
+            kFollower  // derived from the actor's level while it is a teammate of the player
+        };
+
+        Source source = Source::kNone;
+        std::uint16_t souls = 0;
+    };
+
+    class ActorCache {
+    public:
+        static constexpr std::size_t WAYS = 8;
+
+        struct Stats {
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t evictions;
+        };
+
+        // `capacity` is rounded up to a power-of-two number of sets
+        explicit ActorCache(std::size_t capacity)
+            : _sets(std::bit_ceil((std::max<std::size_t>(capacity, 1) + WAYS - 1) / WAYS)),
+              _setCount(_sets.size()),
+              _shift(static_cast<std::uint32_t>(32 - std::countr_zero(_setCount))) {}
+
+        // The cached progression of `formID`, or `resolve()` cached for it. `resolve` runs outside the set lock, so it
+        // may be slow; two threads missing the same actor both resolve it and the later store wins.
+        template <class F>
+        ActorProgression Get(std::uint32_t formID, std::uint32_t generation, F&& resolve) {
+            auto& set = _sets[SetIndex(formID)];
+            {
+                SetLock lock(set);
+                for (std::size_t way = 0; way < WAYS; way++) {
+                    if (set.formIDs[way] == formID && set.generations[way] == generation) {
+                        set.lastUsed[way] = ++set.clock;
+                        set.hits++;
+                        return set.progression[way];
+                    }
+                }
+                set.misses++;
+            }
+
+            ActorProgression progression = resolve();
+
+            SetLock lock(set);
+            std::size_t victim = 0;
+            for (std::size_t way = 0; way < WAYS; way++) {
+                if (set.formIDs[way] == formID) {
+                    victim = way;
+                    break;
+                }
+                if (set.formIDs[way] == 0 || set.lastUsed[way] < set.lastUsed[victim]) {
+                    victim = way;
+                }
+            }
+            if (set.formIDs[victim] != 0 && set.formIDs[victim] != formID) {
+                set.evictions++;
+            }
+            set.formIDs[victim] = formID;
+            set.generations[victim] = generation;
+            set.progression[victim] = progression;
+            set.lastUsed[victim] = ++set.clock;
+            return progression;
+        }
+
+        std::size_t Capacity() const { return _setCount * WAYS; }
+        std::size_t GetMemoryFootprint() const { return _setCount * sizeof(Set); }
+
+        Stats GetStats() const {
+            Stats stats{};
+            for (std::size_t i = 0; i < _setCount; i++) {
+                SetLock lock(_sets[i]);
+                stats.hits += _sets[i].hits;
+                stats.misses += _sets[i].misses;
+                stats.evictions += _sets[i].evictions;
+            }
+            return stats;
+        }
+
+    private:
+        struct alignas(64) Set {
+            mutable std::atomic<bool> locked{ false };
+            std::uint32_t clock = 0;  // LRU clock of this set, so slots compare by their last use
+            std::array<std::uint32_t, WAYS> formIDs{};  // 0 = free
+            std::array<std::uint32_t, WAYS> generations{};
+            std::array<std::uint32_t, WAYS> lastUsed{};
+            std::array<ActorProgression, WAYS> progression{};
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+        };
+
+        class SetLock {
+        public:
+            explicit SetLock(const Set& set) : _set(set) {
+                while (_set.locked.exchange(true, std::memory_order_acquire)) {
+                    while (_set.locked.load(std::memory_order_relaxed)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            ~SetLock() { _set.locked.store(false, std::memory_order_release); }
+
+            SetLock(const SetLock&) = delete;
+            SetLock& operator=(const SetLock&) = delete;
+
+        private:
+            const Set& _set;
+        };
+
+        // Fibonacci hashing, as in FlatFormMap; widened so a single set (shift 32) stays defined
+        std::size_t SetIndex(std::uint32_t formID) const {
+            return static_cast<std::size_t>(std::uint64_t{ formID * 0x9E3779B1u } >> _shift) & (_setCount - 1);
+        }
+
+        TrackedVector<Set, Subsystem::kActorCache> _sets;  // never resized, so Set need not be movable
+        std::size_t _setCount;
+        std::uint32_t _shift;
+    };
+}
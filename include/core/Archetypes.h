@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+
+// What each magic effect archetype scales, resolved once per effect when the plan is compiled.
+//
+// Archetype mirrors RE::EffectArchetypes::ArchetypeID (GameForms checks the values), so the table is indexed directly
+// by the id stored in the effect's EffectSetting. Archetypes not listed keep the original behaviour of scaling the
+// magnitude only. Durations follow the magnitude multiplier and areas the distance multiplier.
+namespace Core {
+    enum class Archetype : std::uint8_t {
+        kValueModifier,
+        kScript,
+        kDispel,
+        kCureDisease,
+        kAbsorb,
+        kDualValueModifier,
+        kCalm,
+        kDemoralize,
+        kFrenzy,
+        kDisarm,
+        kCommandSummoned,
+        kInvisibility,
+        kLight,
+        kDarkness,
+        kNightEye,
+        kLock,
+        kOpen,
+        kBoundWeapon,
+        kSummonCreature,
+        kDetectLife,
+        kTelekinesis,
+        kParalysis,
+        kReanimate,
+        kSoulTrap,
+        kTurnUndead,
+        kGuide,
+        kWerewolfFeed,
+        kCureParalysis,
+        kCureAddiction,
+        kCurePoison,
+        kConcussion,
+        kValueAndParts,
+        kAccumulateMagnitude,
+        kStagger,
+        kPeakValueModifier,
+        kCloak,
+        kWerewolf,
+        kSlowTime,
+        kRally,
+        kEnhanceWeapon,
+        kSpawnHazard,
+        kEtherealize,
+        kBanish,
+        kSpawnScriptedRef,
+        kDisguise,
+        kGrabActor,
+        kVampireLord,
+        kTotal
+    };
+
+    // Flags: which EffectItem fields an archetype scales
+    enum Scaling : std::uint8_t {
+        kScaleNone = 0,
+        kScaleMagnitude = 1 << 0,         // magnitude * magnitude multiplier
+        kScaleMagnitudeInverse = 1 << 1,  // magnitude / magnitude multiplier, floored (a time scale)
+        kScaleDuration = 1 << 2,          // duration * magnitude multiplier
+        kScaleArea = 1 << 3               // area * distance multiplier
+    };
+
+    inline constexpr auto ARCHETYPE_SCALING = []() {
+        std::array<std::uint8_t, static_cast<std::size_t>(Archetype::kTotal)> table{};
+        table.fill(kScaleMagnitude);
+
+        auto set = [&table](std::uint8_t scaling, std::initializer_list<Archetype> archetypes) {
+            for (auto archetype : archetypes) {
+                table[static_cast<std::size_t>(archetype)] = scaling;
+            }
+        };
+
+        // Damage, healing and stat changes: stronger and wider
+        set(kScaleMagnitude | kScaleArea,
+            { Archetype::kValueModifier, Archetype::kDualValueModifier, Archetype::kPeakValueModifier,
+              Archetype::kAbsorb, Archetype::kAccumulateMagnitude, Archetype::kValueAndParts, Archetype::kStagger,
+              Archetype::kConcussion, Archetype::kDisarm });
+
+        // Magnitude is the highest level affected: higher, longer and wider
+        set(kScaleMagnitude | kScaleDuration | kScaleArea,
+            { Archetype::kCalm, Archetype::kDemoralize, Archetype::kFrenzy, Archetype::kRally, Archetype::kTurnUndead,
+              Archetype::kBanish, Archetype::kCommandSummoned });
+
+        set(kScaleMagnitude | kScaleDuration,
+            { Archetype::kCloak, Archetype::kLight, Archetype::kDetectLife, Archetype::kScript,
+              Archetype::kEnhanceWeapon });
+
+        // Magnitude is unused or a flag: only last longer
+        set(kScaleDuration, { Archetype::kInvisibility, Archetype::kEtherealize, Archetype::kNightEye,
+                              Archetype::kDarkness, Archetype::kDisguise, Archetype::kSummonCreature,
+                              Archetype::kBoundWeapon, Archetype::kReanimate, Archetype::kGuide,
+                              Archetype::kSoulTrap, Archetype::kTelekinesis, Archetype::kSpawnHazard });
+        set(kScaleDuration | kScaleArea, { Archetype::kParalysis });
+
+        // Magnitude is a time scale: slower and longer
+        set(kScaleMagnitudeInverse | kScaleDuration, { Archetype::kSlowTime });
+
+        // Transformations and scripted placements have nothing to scale
+        set(kScaleNone, { Archetype::kWerewolf, Archetype::kVampireLord, Archetype::kWerewolfFeed,
+                          Archetype::kGrabActor, Archetype::kSpawnScriptedRef });
+
+        return table;
+    }();
+
+    constexpr std::uint8_t GetArchetypeScaling(std::uint32_t archetype) {
+        return archetype < ARCHETYPE_SCALING.size() ? ARCHETYPE_SCALING[archetype]
+                                                     : static_cast<std::uint8_t>(kScaleMagnitude);
+    }
+
+    // Archetype names as the Creation Kit shows them, without spaces, for rules files
+    inline constexpr std::string_view ARCHETYPE_NAMES[] = {
+        "ValueModifier", "Script", "Dispel", "CureDisease", "Absorb", "DualValueModifier", "Calm", "Demoralize",
+        "Frenzy", "Disarm", "CommandSummoned", "Invisibility", "Light", "Darkness", "NightEye", "Lock", "Open",
+        "BoundWeapon", "SummonCreature", "DetectLife", "Telekinesis", "Paralysis", "Reanimate", "SoulTrap",
+        "TurnUndead", "Guide", "WerewolfFeed", "CureParalysis", "CureAddiction", "CurePoison", "Concussion",
+        "ValueAndParts", "AccumulateMagnitude", "Stagger", "PeakValueModifier", "Cloak", "Werewolf", "SlowTime",
+        "Rally", "EnhanceWeapon", "SpawnHazard", "Etherealize", "Banish", "SpawnScriptedRef", "Disguise",
+        "GrabActor", "VampireLord"
+    };
+    static_assert(std::size(ARCHETYPE_NAMES) == static_cast<std::size_t>(Archetype::kTotal));
+
+    constexpr std::optional<Archetype> ParseArchetype(std::string_view name) {
+        for (std::size_t i = 0; i < std::size(ARCHETYPE_NAMES); i++) {
+            if (ARCHETYPE_NAMES[i] == name) {
+                return static_cast<Archetype>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    static_assert(GetArchetypeScaling(static_cast<std::uint32_t>(Archetype::kSlowTime)) & kScaleMagnitudeInverse);
+}
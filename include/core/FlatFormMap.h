@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "MemoryAccounting.h"
+
+// Immutable FormID -> value map with open addressing and linear probing, built once and then only read.
+//
+// Slots hold the key and the value side by side, and the table is kept at most half full, so a lookup is one
+// multiply-shift and, in the common case, a single slot read: no hashing of strings, no nodes and no allocation.
+// FormID 0 marks an empty slot; it is never a valid form.
+namespace Core {
+    template <class V, Subsystem S = Subsystem::kRules>
+    class FlatFormMap {
+    public:
+        // Earlier entries win over later ones with the same FormID. Entries with FormID 0 are ignored.
+        void Build(const std::vector<std::pair<std::uint32_t, V>>& entries) {
+            auto capacity = std::bit_ceil(std::max<std::size_t>(entries.size() * 2, 8));
+            _slots.assign(capacity, Slot{});
+            _shift = static_cast<std::uint32_t>(32 - std::countr_zero(capacity));
+            _mask = capacity - 1;
+            _size = 0;
+
+            for (const auto& [formID, value] : entries) {
+                if (formID == 0) {
+                    continue;
+                }
+                auto index = Home(formID);
+                while (_slots[index].formID != 0 && _slots[index].formID != formID) {
+                    index = (index + 1) & _mask;
+                }
+                if (_slots[index].formID == 0) {
+                    _slots[index] = { formID, value };
+                    _size++;
+                }
+            }
+        }
+
+        const V* Find(std::uint32_t formID) const {
+            if (_size == 0 || formID == 0) {
+                return nullptr;
+            }
+            for (auto index = Home(formID);; index = (index + 1) & _mask) {
+                const auto& slot = _slots[index];
+                if (slot.formID == formID) {
+                    return &slot.value;
+                }
+                if (slot.formID == 0) {
+                    return nullptr;
+                }
+            }
+        }
+
+        std::size_t Size() const { return _size; }
+        std::size_t Capacity() const { return _slots.size(); }
+        std::size_t GetMemoryFootprint() const { return _slots.capacity() * sizeof(Slot); }
+
+    private:
+        struct Slot {
+            std::uint32_t formID = 0;
+            V value{};
+        };
+
+        // Fibonacci hashing: load order indices sit in the top byte, so the multiply spreads them into the low bits
+        std::size_t Home(std::uint32_t formID) const {
+            return (static_cast<std::uint32_t>(formID * 0x9E3779B1u) >> _shift) & _mask;
+        }
+
+        TrackedVector<Slot, S> _slots;
+        std::uint32_t _shift = 32;
+        std::size_t _mask = 0;
+        std::size_t _size = 0;
+    };
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace Core {
+    // Read-only memory mapping of a whole file. Empty files and missing files fail to open.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::filesystem::path& path);
+        void Close();
+
+        const std::byte* Data() const { return _data; }
+        std::size_t Size() const { return _size; }
+
+    private:
+        const std::byte* _data = nullptr;
+        std::size_t _size = 0;
+#ifdef _WIN32
+        void* _file = nullptr;
+        void* _mapping = nullptr;
+#endif
+    };
+}
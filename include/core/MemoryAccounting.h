@@ -0,0 +1,199 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Heap accounting for the plugin's long-lived state, by subsystem.
+//
+// The containers holding plans, applied states, rules, curves, caches and batches allocate through TrackedAllocator,
+// which counts allocations and live bytes per subsystem with relaxed atomic adds. All of it is sized at data load (or
+// config reload), so after that the counts stand still: a count that keeps growing while the game runs is an
+// allocation on the cast path. The benchmarks check that the steady-state paths allocate nothing at all.
+namespace Core {
+    enum class Subsystem : std::uint8_t {
+        kPlan,          // compiled records, entries and the spell index
+        kAppliedState,  // what each shout's forms currently hold
+        kBatch,         // prepared batches
+        kRules,         // shout rules and actor rules
+        kCurves,        // baked multiplier tables
+        kActorCache,    // NPC progression cache
+        kTrace,         // trace ring buffer
+        kCoSave,        // applied state read from and written to the SKSE co-save
+        kCount
+    };
+
+    inline constexpr const char* SUBSYSTEM_NAMES[] = { "plan",   "applied state", "batch", "rules",
+                                                       "curves", "actor cache",   "trace", "co-save" };
+    static_assert(std::size(SUBSYSTEM_NAMES) == static_cast<std::size_t>(Subsystem::kCount));
+
+    struct MemoryUsage {
+        std::uint64_t allocations;  // since start
+        std::uint64_t bytes;        // live
+        std::uint64_t peakBytes;
+    };
+
+    class MemoryAccounting {
+    public:
+        static void Allocated(Subsystem subsystem, std::size_t bytes) {
+            auto& counters = For(subsystem);
+            counters.allocations.fetch_add(1, std::memory_order_relaxed);
+            auto live = counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            auto peak = counters.peakBytes.load(std::memory_order_relaxed);
+            while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+            }
+        }
+
+        static void Freed(Subsystem subsystem, std::size_t bytes) {
+            For(subsystem).bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        static MemoryUsage GetUsage(Subsystem subsystem) {
+            const auto& counters = For(subsystem);
+            return { counters.allocations.load(std::memory_order_relaxed),
+                     counters.bytes.load(std::memory_order_relaxed),
+                     counters.peakBytes.load(std::memory_order_relaxed) };
+        }
+
+        static MemoryUsage GetTotal() {
+            MemoryUsage total{};
+            for (std::size_t i = 0; i < static_cast<std::size_t>(Subsystem::kCount); i++) {
+                auto usage = GetUsage(static_cast<Subsystem>(i));
+                total.allocations += usage.allocations;
+                total.bytes += usage.bytes;
+                total.peakBytes += usage.peakBytes;
+            }
+            return total;
+        }
+
+    private:
+        struct Counters {
+            std::atomic<std::uint64_t> allocations{ 0 };
+            std::atomic<std::uint64_t> bytes{ 0 };
+            std::atomic<std::uint64_t> peakBytes{ 0 };
+        };
+
+        static Counters& For(Subsystem subsystem) {
+            static std::array<Counters, static_cast<std::size_t>(Subsystem::kCount)> counters;
+            return counters[static_cast<std::size_t>(subsystem)];
+        }
+    };
+
+    template <class T, Subsystem S>
+    struct TrackedAllocator {
+        using value_type = T;
+
+        template <class U>
+        struct rebind {
+            using other = TrackedAllocator<U, S>;
+        };
+
+        TrackedAllocator() = default;
+        template <class U>
+        TrackedAllocator(const TrackedAllocator<U, S>&) noexcept {}
+
+        T* allocate(std::size_t count) {
+            auto bytes = count * sizeof(T);
+            void* memory;
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                memory = ::operator new(bytes, std::align_val_t{ alignof(T) });
+            } else {
+                memory = ::operator new(bytes);
+            }
+            MemoryAccounting::Allocated(S, bytes);
+            return static_cast<T*>(memory);
+        }
+
+        void deallocate(T* memory, std::size_t count) noexcept {
+            MemoryAccounting::Freed(S, count * sizeof(T));
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::operator delete(memory, std::align_val_t{ alignof(T) });
+            } else {
+                ::operator delete(memory);
+            }
+        }
+
+        template <class U>
+        bool operator==(const TrackedAllocator<U, S>&) const noexcept {
+            return true;
+        }
+    };
+
+    template <class T, Subsystem S>
+    using TrackedVector = std::vector<T, TrackedAllocator<T, S>>;
+
+    // Fixed-address storage for objects that are referenced by pointer and never freed one at a time.
+    //
+    // Reserve(capacity) adds one contiguous block for everything known at load; objects added later (forms created at
+    // runtime) go into small overflow blocks, so nothing already handed out ever moves. Objects are never freed before
+    // the pool, so they must be trivially destructible.
+    template <class T, Subsystem S>
+    class Pool {
+        static_assert(std::is_trivially_destructible_v<T>);
+
+    public:
+        static constexpr std::size_t OVERFLOW_BLOCK = 64;
+
+        Pool() = default;
+        ~Pool() { Release(); }
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        // Allocates room for `capacity` more objects in one block. Objects handed out earlier stay where they are.
+        void Reserve(std::size_t capacity) {
+            if (capacity != 0) {
+                AddBlock(capacity);
+            }
+        }
+
+        T& Emplace() {
+            if (_blocks.empty() || _blocks.back().used == _blocks.back().capacity) {
+                AddBlock(OVERFLOW_BLOCK);
+            }
+            auto& block = _blocks.back();
+            return *new (block.objects + block.used++) T();
+        }
+
+        std::size_t Size() const {
+            std::size_t size = 0;
+            for (const auto& block : _blocks) {
+                size += block.used;
+            }
+            return size;
+        }
+
+        std::size_t GetMemoryFootprint() const {
+            std::size_t bytes = _blocks.capacity() * sizeof(Block);
+            for (const auto& block : _blocks) {
+                bytes += block.capacity * sizeof(T);
+            }
+            return bytes;
+        }
+
+    private:
+        struct Block {
+            T* objects;
+            std::size_t used;
+            std::size_t capacity;
+        };
+
+        void AddBlock(std::size_t capacity) {
+            _blocks.push_back({ TrackedAllocator<T, S>().allocate(capacity), 0, capacity });
+        }
+
+        void Release() {
+            for (const auto& block : _blocks) {
+                TrackedAllocator<T, S>().deallocate(block.objects, block.capacity);
+            }
+            _blocks.clear();
+        }
+
+        TrackedVector<Block, S> _blocks;
+    };
+}
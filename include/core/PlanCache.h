@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "MappedFile.h"
+
+// On-disk cache of a compiled scaling plan: for every shout, its run of records keyed by the form that owns each
+// value (FormID plus variation or effect index) together with the value captured before any scaling.
+//
+// The file is a fixed header, the shout table, the record keys and the shared records, all little-endian PODs read in
+// place from a memory mapping. A cache is used only when its magic, version, layout, load-order hash, sizes and
+// payload checksum all match; anything else is reported as stale or corrupt and the plan is rebuilt from the forms.
+namespace Core {
+    enum class Field : std::uint8_t {
+        kRecoveryTime,     // owner = shout, index = variation
+        kMagnitude,        // owner = spell, index = effect
+        kProjectileSpeed,  // owner = projectile
+        kProjectileRange,  // owner = projectile
+        kDuration,         // owner = spell, index = effect
+        kArea              // owner = spell, index = effect
+    };
+
+    struct RecordKey {
+        std::uint32_t owner;
+        std::uint16_t index;
+        Field field;
+        std::uint8_t transform;  // Core::Transform
+        float original;          // integral values are stored exactly as floats
+    };
+    static_assert(sizeof(RecordKey) == 12);
+
+    struct CachedShout {
+        std::uint32_t formID;
+        std::uint32_t first;
+        std::uint32_t count;
+        std::uint16_t effects;
+        std::uint16_t projectiles;
+        std::uint32_t topology;  // hash of the spells, effects and projectiles the run was compiled from
+    };
+    static_assert(sizeof(CachedShout) == 20);
+
+    // A record whose target other records also write. Records of one group share a target.
+    struct CachedShare {
+        std::uint32_t record;
+        std::uint32_t group;
+    };
+    static_assert(sizeof(CachedShare) == 8);
+
+    struct PlanCacheHeader {
+        static constexpr std::uint16_t VERSION = 4;
+
+        char magic[4] = { 'S', 'P', 'P', 'C' };
+        std::uint16_t version = VERSION;
+        std::uint8_t shoutSize = sizeof(CachedShout);
+        std::uint8_t keySize = sizeof(RecordKey);
+        std::uint64_t loadOrderHash = 0;
+        std::uint32_t shoutCount = 0;
+        std::uint32_t keyCount = 0;
+        std::uint64_t checksum = 0;  // Checksum() of everything after the header
+        std::uint32_t shareCount = 0;
+        std::uint32_t groupCount = 0;
+    };
+    static_assert(sizeof(PlanCacheHeader) == 40);
+
+    // What a build emits for the cache: shouts in build order, keys parallel to the plan's records, and the records
+    // that share a target, so loading the cache does not have to sort every record by target to find them
+    struct PlanCacheData {
+        std::vector<CachedShout> shouts;
+        std::vector<RecordKey> keys;
+        std::vector<CachedShare> shares;
+        std::uint32_t groups = 0;
+    };
+
+    inline constexpr std::uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+
+    inline std::uint64_t Fnv1a(const void* data, std::size_t size, std::uint64_t hash = FNV_OFFSET) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    // FNV-1a over 8-byte words, the tail byte by byte: the payload checksum covers megabytes on every load, and the
+    // byte-wise hash would cost as much as the rest of loading the cache
+    inline std::uint64_t Checksum(const void* data, std::size_t size, std::uint64_t hash = FNV_OFFSET) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        auto words = size / sizeof(std::uint64_t);
+        for (std::size_t i = 0; i < words; i++) {
+            std::uint64_t word;
+            std::memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+            hash = (hash ^ word) * 0x100000001B3ull;
+        }
+        return Fnv1a(bytes + words * sizeof(std::uint64_t), size % sizeof(std::uint64_t), hash);
+    }
+
+    // A plugin as the game numbers it: full plugins by compile index, light plugins by their own index under FE
+    struct IndexedPlugin {
+        std::string_view name;
+        bool light;
+        std::uint32_t index;
+    };
+
+    // The order HashLoadOrder takes plugins in: full plugins by compile index, then light plugins by light index. The
+    // game's file list interleaves them by plugins.txt position, which the offline compiler does not see the same way,
+    // but both agree on the indices.
+    inline std::vector<std::string_view> CanonicalLoadOrder(std::vector<IndexedPlugin> plugins) {
+        std::sort(plugins.begin(), plugins.end(), [](const IndexedPlugin& a, const IndexedPlugin& b) {
+            return a.light != b.light ? b.light : a.index < b.index;
+        });
+        std::vector<std::string_view> names;
+        names.reserve(plugins.size());
+        for (const auto& plugin : plugins) {
+            names.push_back(plugin.name);
+        }
+        return names;
+    }
+
+    // Identifies what a plan was compiled from: the name, size and last write time of every active plugin in load
+    // order, plus the number of shouts. Anything that could change a shout's forms changes one of these. Write times
+    // are hashed as Unix seconds, so the offline compiler (tools/PlanCompile.cpp) gets the same hash on any host.
+    template <class Names>
+    std::uint64_t HashLoadOrder(const std::filesystem::path& dataDirectory, const Names& names,
+                                std::uint64_t shoutCount) {
+        auto hash = FNV_OFFSET;
+        for (const auto& entry : names) {
+            std::string_view name = entry;
+            hash = Fnv1a(name.data(), name.size(), hash);
+
+            std::error_code error;
+            auto path = dataDirectory / name;
+            std::uint64_t size = std::filesystem::file_size(path, error);
+            if (error) {
+                size = 0;
+            }
+            std::int64_t written = 0;
+            auto time = std::filesystem::last_write_time(path, error);
+            if (!error) {
+                written = std::chrono::duration_cast<std::chrono::seconds>(
+                              std::chrono::file_clock::to_sys(time).time_since_epoch())
+                              .count();
+            }
+            hash = Fnv1a(&size, sizeof(size), hash);
+            hash = Fnv1a(&written, sizeof(written), hash);
+        }
+        return Fnv1a(&shoutCount, sizeof(shoutCount), hash);
+    }
+
+    // Writes to a temporary file and renames it over `path`, so a crash never leaves a half-written cache behind
+    inline bool WritePlanCache(const std::filesystem::path& path, std::uint64_t loadOrderHash,
+                               const PlanCacheData& data) {
+        PlanCacheHeader header;
+        header.loadOrderHash = loadOrderHash;
+        header.shoutCount = static_cast<std::uint32_t>(data.shouts.size());
+        header.keyCount = static_cast<std::uint32_t>(data.keys.size());
+        header.shareCount = static_cast<std::uint32_t>(data.shares.size());
+        header.groupCount = data.groups;
+        header.checksum = Checksum(data.shouts.data(), data.shouts.size() * sizeof(CachedShout));
+        header.checksum = Checksum(data.keys.data(), data.keys.size() * sizeof(RecordKey), header.checksum);
+        header.checksum = Checksum(data.shares.data(), data.shares.size() * sizeof(CachedShare), header.checksum);
+
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(data.shouts.data()),
+                       static_cast<std::streamsize>(data.shouts.size() * sizeof(CachedShout)));
+            file.write(reinterpret_cast<const char*>(data.keys.data()),
+                       static_cast<std::streamsize>(data.keys.size() * sizeof(RecordKey)));
+            file.write(reinterpret_cast<const char*>(data.shares.data()),
+                       static_cast<std::streamsize>(data.shares.size() * sizeof(CachedShare)));
+            if (!file) {
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        return !error;
+    }
+
+    class PlanCacheView {
+    public:
+        // Maps and validates the cache. On failure `error` says why (missing, stale or corrupt).
+        bool Open(const std::filesystem::path& path, std::uint64_t loadOrderHash, std::string& error) {
+            if (!_file.Open(path)) {
+                error = "no cache file";
+                return false;
+            }
+            if (_file.Size() < sizeof(PlanCacheHeader)) {
+                return Fail("truncated header", error);
+            }
+
+            std::memcpy(&_header, _file.Data(), sizeof(_header));
+            if (std::memcmp(_header.magic, "SPPC", 4) != 0) {
+                return Fail("not a plan cache", error);
+            }
+            if (_header.version != PlanCacheHeader::VERSION || _header.shoutSize != sizeof(CachedShout) ||
+                _header.keySize != sizeof(RecordKey)) {
+                return Fail("written by a different version", error);
+            }
+            if (_header.loadOrderHash != loadOrderHash) {
+                return Fail("load order changed", error);
+            }
+
+            auto expected = sizeof(PlanCacheHeader) + std::size_t{ _header.shoutCount } * sizeof(CachedShout) +
+                            std::size_t{ _header.keyCount } * sizeof(RecordKey) +
+                            std::size_t{ _header.shareCount } * sizeof(CachedShare);
+            if (_file.Size() != expected) {
+                return Fail("size does not match header", error);
+            }
+
+            // All tables are 4-byte aligned PODs at 4-byte aligned offsets in a page-aligned mapping
+            const auto* payload = _file.Data() + sizeof(PlanCacheHeader);
+            _shouts = { reinterpret_cast<const CachedShout*>(payload), _header.shoutCount };
+            _keys = { reinterpret_cast<const RecordKey*>(payload + _shouts.size_bytes()), _header.keyCount };
+            _shares = { reinterpret_cast<const CachedShare*>(payload + _shouts.size_bytes() + _keys.size_bytes()),
+                        _header.shareCount };
+
+            auto checksum = Checksum(_shouts.data(), _shouts.size_bytes());
+            checksum = Checksum(_keys.data(), _keys.size_bytes(), checksum);
+            if (Checksum(_shares.data(), _shares.size_bytes(), checksum) != _header.checksum) {
+                return Fail("checksum mismatch", error);
+            }
+
+            for (const auto& shout : _shouts) {
+                if (std::uint64_t{ shout.first } + shout.count > _header.keyCount) {
+                    return Fail("record range out of bounds", error);
+                }
+            }
+            for (const auto& share : _shares) {
+                if (share.record >= _header.keyCount || share.group >= _header.groupCount) {
+                    return Fail("shared record out of bounds", error);
+                }
+            }
+            return true;
+        }
+
+        std::span<const CachedShout> Shouts() const { return _shouts; }
+        std::span<const RecordKey> Keys() const { return _keys; }
+        std::span<const CachedShare> Shares() const { return _shares; }
+        std::uint32_t Groups() const { return _header.groupCount; }
+
+    private:
+        bool Fail(const char* reason, std::string& error) {
+            error = reason;
+            _file.Close();
+            _shouts = {};
+            _keys = {};
+            _shares = {};
+            return false;
+        }
+
+        MappedFile _file;
+        PlanCacheHeader _header;
+        std::span<const CachedShout> _shouts;
+        std::span<const RecordKey> _keys;
+        std::span<const CachedShare> _shares;
+    };
+}
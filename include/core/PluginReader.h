@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "PlanCache.h"
+
+// Reads the forms a scaling plan is compiled from straight out of plugin files, so the plan (and its on-disk cache) can
+// be built off the game (tools/PlanCompile.cpp).
+//
+// Every plugin of the load order is memory-mapped and walked at the group level: only the top-level SHOU, SPEL, MGEF
+// and PROJ groups are entered, everything else (cells, worldspaces, NPCs...) is skipped by its group size without
+// being touched. Of each record only the fields the plan reads are decoded, after override order has picked the last
+// plugin's version of it. FormIDs are rewritten to the ones the game assigns (full plugins by load order index, light
+// plugins under FE), so the forms and the cache keys match what the plugin captures at runtime.
+//
+// The forms mirror the CommonLib member names the core reads, like the mock forms in bench/, and Esp::Forms binds
+// Core::Plan to them.
+namespace Esp {
+    struct BGSProjectile {
+        struct Data {
+            float speed;
+            float range;
+        } data;
+        std::uint32_t formID;
+        std::string_view editorID;
+    };
+
+    struct EffectSetting {
+        struct Data {
+            BGSProjectile* projectileBase;
+        } data;
+        std::uint32_t archetype;  // Core::Archetype
+        std::uint32_t formID;
+        std::string_view editorID;
+    };
+
+    struct Effect {
+        struct EffectItem {
+            float magnitude;
+            std::uint32_t area;
+            std::uint32_t duration;
+        } effectItem;
+        EffectSetting* baseEffect;
+    };
+
+    struct SpellItem {
+        std::vector<Effect*> effects;
+        std::uint32_t formID;
+        std::string_view editorID;
+    };
+
+    struct TESWordOfPower {
+        std::uint32_t formID;
+    };
+
+    struct TESShout {
+        struct Variation {
+            TESWordOfPower* word;
+            SpellItem* spell;
+            float recoveryTime;
+        };
+
+        Variation variations[3];
+        std::uint32_t formID;
+        std::string_view editorID;
+    };
+
+    struct Forms {
+        using Shout = TESShout;
+        using Spell = SpellItem;
+
+        static std::uint32_t GetArchetype(EffectSetting* effect) { return effect->archetype; }
+        static bool IsWordKnown(TESWordOfPower*) { return false; }  // no save game off the game
+
+        template <class T>
+        static std::uint32_t GetFormID(const T* form) {
+            return form->formID;
+        }
+
+        // Resolve against the most recently read load order, as the game resolves against its one data handler
+        static Shout* LookupShout(std::uint32_t formID);
+        static void* Resolve(const Core::RecordKey& key);
+    };
+
+    struct ReadStats {
+        std::uint64_t bytesMapped = 0;   // size of every plugin
+        std::uint64_t bytesWalked = 0;   // size of the groups that were entered
+        std::uint32_t groupsSkipped = 0;
+        std::uint32_t records = 0;       // SHOU, SPEL, MGEF and PROJ records, overrides included
+        std::uint32_t overrides = 0;     // records replaced by a later plugin
+        std::uint32_t compressed = 0;    // records that had to be inflated
+        std::uint32_t unresolved = 0;    // references to forms no plugin defines
+    };
+
+    // A projectile the plan scales that other spells also fire, so scaling a shout changes those spells too
+    struct SharedProjectile {
+        const BGSProjectile* projectile;
+        std::vector<const TESShout*> shouts;
+        std::vector<const SpellItem*> spells;  // spells no shout uses
+    };
+
+    // A spell used by more than one shout: each of them scales it with its own multipliers
+    struct SharedSpell {
+        const SpellItem* spell;
+        std::vector<const TESShout*> shouts;
+    };
+
+    class LoadOrder {
+    public:
+        LoadOrder();
+        ~LoadOrder();
+
+        LoadOrder(const LoadOrder&) = delete;
+        LoadOrder& operator=(const LoadOrder&) = delete;
+
+        // Maps and reads `plugins` (file names in plugins.txt order) from `dataDirectory`. Masters and .esl files are
+        // moved ahead of regular plugins as the game does; GetPlugins() has the resulting load order. On failure
+        // `error` names the plugin and the reason, and the load order is left empty.
+        bool Read(const std::filesystem::path& dataDirectory, const std::vector<std::string>& plugins,
+                  std::string& error);
+
+        // Every shout in the order the game creates them: by the plugin that first defines it, then by file position
+        std::vector<TESShout*> shouts;
+
+        const ReadStats& GetStats() const { return _stats; }
+        const std::vector<std::string>& GetPlugins() const { return _plugins; }
+
+        // The plugins in Core::CanonicalLoadOrder, the order the plan cache's load-order hash takes them in
+        std::vector<std::string_view> GetCanonicalPlugins() const;
+
+        std::vector<SharedProjectile> FindSharedProjectiles() const;
+        std::vector<SharedSpell> FindSharedSpells() const;
+
+        static LoadOrder*& Active() {
+            static LoadOrder* active = nullptr;
+            return active;
+        }
+
+    private:
+        friend struct Forms;
+
+        struct File;
+        struct Raw;
+
+        bool Index(std::size_t fileIndex, std::string& error);
+        bool Decode(std::string& error);
+        void Clear();
+
+        std::vector<std::string> _plugins;
+        std::vector<std::unique_ptr<File>> _files;
+        std::deque<std::vector<std::byte>> _inflated;  // decompressed records, referenced by the forms' editor IDs
+
+        std::deque<BGSProjectile> _projectiles;
+        std::deque<EffectSetting> _effectSettings;
+        std::deque<Effect> _effects;
+        std::deque<SpellItem> _spells;
+        std::deque<TESWordOfPower> _words;
+        std::deque<TESShout> _shouts;
+
+        struct Lookup;
+        std::unique_ptr<Lookup> _lookup;
+
+        ReadStats _stats;
+    };
+
+    // The plugins the game would load for a plugins.txt: the base game masters and the Skyrim.ccc entries present in
+    // `dataDirectory` first, then the active (*) plugins in file order. Empty when plugins.txt cannot be read.
+    std::vector<std::string> ReadPluginsTxt(const std::filesystem::path& pluginsTxt,
+                                            const std::filesystem::path& dataDirectory);
+}
@@ -0,0 +1,993 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Archetypes.h"
+#include "MemoryAccounting.h"
+#include "PlanCache.h"
+#include "Snapshot.h"
+
+// Form-independent half of the scaling plan: compiling shouts into record runs, applying and restoring them, and the
+// applied-state cache. ScalingPlan binds it to CommonLib's forms; the benchmarks bind it to mock forms.
+//
+// `Forms` names the shout and spell types and answers the queries that are calls in CommonLib:
+//
+//   struct Forms {
+//       using Shout = ...;
+//       using Spell = ...;                                // what a variation's `spell` converts to
+//       static std::uint32_t GetArchetype(EffectSetting* effect);  // a Core::Archetype value
+//       static bool IsWordKnown(WordOfPower* word);
+//       static std::uint32_t GetFormID(const Form* form);  // shouts, spells and projectiles
+//       static Shout* LookupShout(std::uint32_t formID);   // for plans loaded from a cache
+//       static void* Resolve(const RecordKey& key);        // nullptr when the form or index no longer exists
+//   };
+//
+// Everything else is reached through the member names CommonLib uses (shout->variations, variation.recoveryTime,
+// variation.spell, spell->effects, effect->effectItem.magnitude/duration/area, effect->baseEffect->data.projectileBase,
+// projectile->data.speed/range), which the mock forms mirror.
+namespace Core {
+    enum class Transform : std::uint8_t {
+        kCooldown,          // recoveryTime * cooldown multiplier
+        kMagnitude,         // magnitude * magnitude multiplier
+        kMagnitudeInverse,  // magnitude / magnitude multiplier, floored (SlowTime)
+        kDistance,          // projectile speed/range * distance multiplier
+        kDuration,          // effect duration * magnitude multiplier, rounded (std::uint32_t target)
+        kArea               // effect area * distance multiplier, rounded (std::uint32_t target)
+    };
+
+    constexpr bool IsIntegral(Transform transform) {
+        return transform == Transform::kDuration || transform == Transform::kArea;
+    }
+
+    // `target` is a float, or a std::uint32_t for integral transforms; `original` holds either exactly
+    struct Record {
+        void* target;
+        float original;
+        Transform transform;
+    };
+
+    inline float LoadValue(const void* target, Transform transform) {
+        return IsIntegral(transform) ? static_cast<float>(*static_cast<const std::uint32_t*>(target))
+                                     : *static_cast<const float*>(target);
+    }
+
+    // Scaled durations and areas are never negative, so rounding is an add and a truncation rather than a libm call
+    inline std::uint32_t RoundValue(float value) {
+        return static_cast<std::uint32_t>(value + 0.5f);
+    }
+
+    inline void StoreValue(const Record& record, float value) {
+        if (IsIntegral(record.transform)) {
+            *static_cast<std::uint32_t*>(record.target) = RoundValue(value);
+        } else {
+            *static_cast<float*>(record.target) = value;
+        }
+    }
+
+    struct Multipliers {
+        float distance;
+        float magnitude;
+        float cooldown;
+    };
+
+    // What one Build worker did
+    struct WorkerStats {
+        std::uint32_t shouts;
+        std::uint32_t records;
+        std::uint64_t nanoseconds;
+    };
+
+    struct CacheStats {
+        std::uint64_t applyHits;
+        std::uint64_t applyMisses;
+        std::uint64_t restoreHits;
+        std::uint64_t restoreMisses;
+    };
+
+    inline constexpr float MIN_TIME_SCALE = 0.05f;
+
+    // Identifies the values a shout was scaled for. Generations start at 1, so a stamp is never 0.
+    constexpr std::uint64_t MakeStamp(std::uint32_t configGeneration, int totalSouls) {
+        return (static_cast<std::uint64_t>(configGeneration) << 32) | static_cast<std::uint32_t>(totalSouls);
+    }
+
+    // Stamps of shouts an NPC scaled with its own souls (bNPCProgression) carry the top bit, so they never match the
+    // player's stamp for the same soul count and are not saved as the player's state
+    inline constexpr std::uint64_t NPC_STAMP = std::uint64_t{ 1 } << 63;
+
+    constexpr std::uint64_t MakeNPCStamp(std::uint32_t configGeneration, int souls) {
+        return MakeStamp(configGeneration, souls) | NPC_STAMP;
+    }
+
+    constexpr bool IsNPCStamp(std::uint64_t stamp) {
+        return (stamp & NPC_STAMP) != 0;
+    }
+
+    constexpr int StampSouls(std::uint64_t stamp) {
+        return static_cast<int>(static_cast<std::uint32_t>(stamp));
+    }
+
+    inline float ScaleRecord(const Record& record, const Multipliers& multipliers) {
+        switch (record.transform) {
+            case Transform::kCooldown:
+                return record.original * multipliers.cooldown;
+            case Transform::kMagnitude:
+                return record.original * multipliers.magnitude;
+            case Transform::kMagnitudeInverse:
+                return std::max(record.original / multipliers.magnitude, MIN_TIME_SCALE);
+            case Transform::kDistance:
+            case Transform::kArea:
+                return record.original * multipliers.distance;
+            case Transform::kDuration:
+                return record.original * multipliers.magnitude;
+        }
+        return record.original;
+    }
+
+    // One dispatch per record: the transform selects both the multiplier and the store width
+    inline void ApplyRecords(const Record* begin, const Record* end, const Multipliers& multipliers) {
+        for (const auto* record = begin; record != end; ++record) {
+            auto* value = static_cast<float*>(record->target);
+            auto* integral = static_cast<std::uint32_t*>(record->target);
+            switch (record->transform) {
+                case Transform::kCooldown:
+                    *value = record->original * multipliers.cooldown;
+                    break;
+                case Transform::kMagnitude:
+                    *value = record->original * multipliers.magnitude;
+                    break;
+                case Transform::kMagnitudeInverse:
+                    *value = std::max(record->original / multipliers.magnitude, MIN_TIME_SCALE);
+                    break;
+                case Transform::kDistance:
+                    *value = record->original * multipliers.distance;
+                    break;
+                case Transform::kDuration:
+                    *integral = RoundValue(record->original * multipliers.magnitude);
+                    break;
+                case Transform::kArea:
+                    *integral = RoundValue(record->original * multipliers.distance);
+                    break;
+            }
+        }
+    }
+
+    inline void RestoreRecords(const Record* begin, const Record* end) {
+        // Both widths are 4-byte stores, so the bits are picked with a select instead of a branch per record
+        for (const auto* record = begin; record != end; ++record) {
+            auto bits = IsIntegral(record->transform) ? static_cast<std::uint32_t>(record->original)
+                                                      : std::bit_cast<std::uint32_t>(record->original);
+            std::memcpy(record->target, &bits, sizeof(bits));
+        }
+    }
+
+    template <class Forms>
+    class Plan {
+    public:
+        using Shout = typename Forms::Shout;
+        using Spell = typename Forms::Spell;
+
+        static constexpr std::uint64_t RESTORED = 0;
+
+        static constexpr std::uint32_t NOT_APPLIED = UINT32_MAX;
+
+        // What the shout's forms hold: the stamp they were scaled for, or RESTORED. `applied` is the shout's slot in
+        // the applied set while its stamp is not RESTORED.
+        struct AppliedState {
+            std::atomic<std::uint64_t> stamp{ RESTORED };
+            std::uint32_t applied = NOT_APPLIED;
+            bool kept = false;  // Reconcile's mark
+        };
+
+        // A target written by more than one shout (a shared projectile, or an effect of a spell reused across
+        // shouts). Its value depends only on the multiplier its transform selects, so the token is that multiplier's
+        // bits (tagged so it is never 0), RESTORED_TOKEN for the original, or UNKNOWN_TOKEN when nothing is known. A
+        // shout's stamp is only trusted while every target it shares still holds its own token: another shout
+        // rewriting the target with other multipliers (an NPC's souls, a per-shout rule) invalidates it.
+        static constexpr std::uint64_t RESTORED_TOKEN = 0;
+        static constexpr std::uint64_t UNKNOWN_TOKEN = 1;
+
+        struct SharedTarget {
+            std::atomic<std::uint64_t> token{ UNKNOWN_TOKEN };
+        };
+
+        struct SharedRecord {
+            SharedTarget* target;
+            std::uint32_t record;  // index into Snapshot::records
+            Transform transform;
+        };
+
+        struct Entry {
+            Shout* shout;
+            AppliedState* state;
+            std::uint32_t first;
+            std::uint32_t count;
+            std::uint32_t sharedFirst;  // the shout's run in Snapshot::shared
+            std::uint32_t sharedCount;
+            std::uint16_t effects;
+            std::uint16_t projectiles;
+        };
+
+        struct SpellEntry {
+            const Spell* spell;
+            Shout* shout;
+        };
+
+        using Records = TrackedVector<Record, Subsystem::kPlan>;
+        using Entries = TrackedVector<Entry, Subsystem::kPlan>;
+        using SpellEntries = TrackedVector<SpellEntry, Subsystem::kPlan>;
+        using Targets = TrackedVector<const void*, Subsystem::kPlan>;
+        using SharedRecords = TrackedVector<SharedRecord, Subsystem::kPlan>;
+
+        struct Snapshot {
+            Records records;
+            Entries entries;      // sorted by shout pointer
+            SpellEntries spells;  // sorted by spell pointer
+            SharedRecords shared;  // the records whose target another shout also writes, in entry order
+
+            const Entry* Find(const Shout* shout) const {
+                auto it = std::lower_bound(entries.begin(), entries.end(), shout,
+                                           [](const Entry& entry, const Shout* key) { return entry.shout < key; });
+                return it != entries.end() && it->shout == shout ? &*it : nullptr;
+            }
+
+            std::size_t GetMemoryFootprint() const {
+                return sizeof(Snapshot) + records.capacity() * sizeof(Record) + entries.capacity() * sizeof(Entry) +
+                       spells.capacity() * sizeof(SpellEntry) + shared.capacity() * sizeof(SharedRecord) +
+                       entries.size() * sizeof(AppliedState);
+            }
+        };
+
+        // Outcome of Apply/Restore
+        struct Write {
+            const Entry* entry;
+            const Record* records;  // the shout's run of entry->count records
+            std::uint32_t written;  // 0 when the forms already held the requested values
+            bool compiled;          // the shout was not in the plan and was compiled by this call
+        };
+
+        // Scaled values for a set of shouts, computed ahead of the cast by Prepare and written by Commit
+        struct Batch {
+            const Snapshot* snapshot = nullptr;  // the entries' snapshot; published snapshots are never freed
+            TrackedVector<const Entry*, Subsystem::kBatch> entries;
+            TrackedVector<float, Subsystem::kBatch> values;  // the entries' record runs, concatenated
+            TrackedVector<Multipliers, Subsystem::kBatch> multipliers;  // one per entry
+            std::uint64_t stamp = RESTORED;
+        };
+
+        // Compiles every shout in `shouts` (a random-access range of Shout*, nulls skipped) and publishes the result.
+        // With `cache`, also emits what WritePlanCache needs to store the plan.
+        //
+        // With more than one thread the range is split into contiguous slices compiled in parallel, each into its own
+        // buffers, and then concatenated in order, so the plan and the cache are identical for any thread count. One
+        // WorkerStats per thread is written to `stats` when given.
+        //
+        // Building again is safe for readers of the previous snapshot, whose states stay allocated, but the new plan
+        // takes the forms' current values as originals and every shout as restored: build before anything is scaled.
+        template <class Range>
+        const Snapshot* Build(const Range& shouts, PlanCacheData* cache = nullptr, unsigned threads = 1,
+                              std::vector<WorkerStats>* stats = nullptr) {
+            struct Slice {
+                Records records;
+                Entries entries;
+                SpellEntries spells;
+                Targets seen;  // Compile's scratch, reused across the slice's shouts
+                PlanCacheData cache;
+                WorkerStats stats{};
+            };
+
+            const std::size_t count = std::size(shouts);
+            threads = static_cast<unsigned>(std::clamp<std::size_t>(threads, 1, count ? count : 1));
+            std::vector<Slice> slices(threads);
+
+            auto work = [&](unsigned index) {
+                auto start = std::chrono::steady_clock::now();
+                auto& slice = slices[index];
+                for (auto i = count * index / threads, end = count * (index + 1) / threads; i < end; i++) {
+                    auto* shout = shouts[i];
+                    if (!shout) {
+                        continue;
+                    }
+                    auto entry = Compile(shout, slice.records, slice.seen, cache ? &slice.cache.keys : nullptr);
+                    if (cache) {
+                        slice.cache.shouts.push_back({ Forms::GetFormID(shout), entry.first, entry.count,
+                                                       entry.effects, entry.projectiles, HashTopology(shout) });
+                    }
+                    slice.entries.push_back(entry);
+                    IndexSpells(shout, slice.spells);
+                }
+                slice.stats = { static_cast<std::uint32_t>(slice.entries.size()),
+                                static_cast<std::uint32_t>(slice.records.size()),
+                                static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                               std::chrono::steady_clock::now() - start)
+                                                               .count()) };
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for (unsigned index = 1; index < threads; index++) {
+                workers.emplace_back(work, index);
+            }
+            work(0);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            // Concatenate in slice order, rebasing record runs and handing out applied states on this thread
+            auto snapshot = std::make_unique<Snapshot>();
+            std::size_t total = 0;
+            for (const auto& slice : slices) {
+                total += slice.entries.size();
+            }
+            ResetStates(total);
+            if (stats) {
+                stats->clear();
+            }
+            for (auto& slice : slices) {
+                auto base = static_cast<std::uint32_t>(snapshot->records.size());
+                snapshot->records.insert(snapshot->records.end(), slice.records.begin(), slice.records.end());
+                for (auto entry : slice.entries) {
+                    entry.first += base;
+                    entry.state = &_states.Emplace();
+                    snapshot->entries.push_back(entry);
+                }
+                snapshot->spells.insert(snapshot->spells.end(), slice.spells.begin(), slice.spells.end());
+                if (cache) {
+                    for (auto shout : slice.cache.shouts) {
+                        shout.first += base;
+                        cache->shouts.push_back(shout);
+                    }
+                    cache->keys.insert(cache->keys.end(), slice.cache.keys.begin(), slice.cache.keys.end());
+                }
+                if (stats) {
+                    stats->push_back(slice.stats);
+                }
+            }
+
+            const auto* published = Publish(std::move(snapshot));
+            if (cache) {
+                RecordShares(*published, *cache);
+            }
+            return published;
+        }
+
+        // Rebuilds the plan from a validated cache without compiling. Every cached value is checked against its form,
+        // and every shout's topology (which spells, effects and projectiles its run was compiled from) against a hash
+        // of its forms, so a form changed without a plugin change is caught: a swapped projectile or an effect added
+        // at runtime as well as a changed value. Shared targets come from the cache's groups, each checked to resolve
+        // to one target, instead of sorting every record by target. On any mismatch nothing is published and `error`
+        // says why.
+        const Snapshot* BuildFromCache(const PlanCacheView& cache, std::string& error) {
+            auto snapshot = std::make_unique<Snapshot>();
+            snapshot->records.reserve(cache.Keys().size());
+            snapshot->entries.reserve(cache.Shouts().size());
+
+            for (const auto& key : cache.Keys()) {
+                if (key.transform > static_cast<std::uint8_t>(Transform::kArea)) {
+                    error = "unknown transform";
+                    return nullptr;
+                }
+                auto* target = Forms::Resolve(key);
+                if (!target) {
+                    error = "a cached form no longer exists";
+                    return nullptr;
+                }
+                auto transform = static_cast<Transform>(key.transform);
+                if (std::bit_cast<std::uint32_t>(LoadValue(target, transform)) !=
+                    std::bit_cast<std::uint32_t>(key.original)) {
+                    error = "a cached value no longer matches its form";
+                    return nullptr;
+                }
+                snapshot->records.push_back({ target, key.original, transform });
+            }
+
+            for (const auto& cached : cache.Shouts()) {
+                auto* shout = Forms::LookupShout(cached.formID);
+                if (!shout) {
+                    error = "a cached shout no longer exists";
+                    return nullptr;
+                }
+                if (HashTopology(shout) != cached.topology) {
+                    error = "a cached shout's spells, effects or projectiles changed";
+                    return nullptr;
+                }
+            }
+
+            std::vector<const void*> groups(cache.Groups(), nullptr);
+            for (const auto& share : cache.Shares()) {
+                const auto* target = snapshot->records[share.record].target;
+                auto& group = groups[share.group];
+                if (group && group != target) {
+                    error = "cached shared records no longer share a form";
+                    return nullptr;
+                }
+                group = target;
+            }
+
+            ResetStates(cache.Shouts().size());
+            for (const auto& cached : cache.Shouts()) {
+                auto* shout = Forms::LookupShout(cached.formID);
+                snapshot->entries.push_back({ shout, &_states.Emplace(), cached.first, cached.count, 0, 0,
+                                              cached.effects, cached.projectiles });
+                IndexSpells(shout, snapshot->spells);
+            }
+
+            return Publish(std::move(snapshot), &cache);
+        }
+
+        Write Apply(Shout* shout, const Multipliers& multipliers, std::uint64_t stamp) {
+            auto [snapshot, entry, compiled] = FindOrCompile(shout);
+            auto& state = *entry->state;
+            const auto* begin = snapshot->records.data() + entry->first;
+
+            if (state.stamp.load(std::memory_order_relaxed) == stamp && Holds(*snapshot, *entry, &multipliers)) {
+                _applyHits.fetch_add(1, std::memory_order_relaxed);
+                return { entry, begin, 0, compiled };
+            }
+            _applyMisses.fetch_add(1, std::memory_order_relaxed);
+
+            ApplyRecords(begin, begin + entry->count, multipliers);
+
+            SetStamp(entry->shout, state, stamp);
+            Claim(*snapshot, *entry, &multipliers);
+
+            return { entry, begin, entry->count, compiled };
+        }
+
+        Write Restore(Shout* shout) {
+            auto [snapshot, entry, compiled] = FindOrCompile(shout);
+            auto& state = *entry->state;
+            const auto* begin = snapshot->records.data() + entry->first;
+
+            if (state.stamp.load(std::memory_order_relaxed) == RESTORED && Holds(*snapshot, *entry, nullptr)) {
+                _restoreHits.fetch_add(1, std::memory_order_relaxed);
+                return { entry, begin, 0, compiled };
+            }
+            _restoreMisses.fetch_add(1, std::memory_order_relaxed);
+
+            RestoreRecords(begin, begin + entry->count);
+
+            SetStamp(entry->shout, state, RESTORED);
+            Claim(*snapshot, *entry, nullptr);
+
+            return { entry, begin, entry->count, compiled };
+        }
+
+        // Computes the scaled value of every record of `shouts` into `batch` without touching the forms: only the
+        // published snapshot is read, so this is safe on any thread. `multipliersFor(shout)` gives each shout's
+        // multipliers. Shouts that are not in the plan are left to the cast path, which compiles them. `batch` is
+        // reused, so steady-state preparation does not allocate.
+        template <class Range, class F>
+        void Prepare(const Range& shouts, F&& multipliersFor, std::uint64_t stamp, Batch& batch) const {
+            batch.entries.clear();
+            batch.values.clear();
+            batch.multipliers.clear();
+            batch.stamp = stamp;
+
+            const auto* snapshot = batch.snapshot = _snapshot.Load();
+            if (!snapshot) {
+                return;
+            }
+            for (auto* shout : shouts) {
+                const auto* entry = shout ? snapshot->Find(shout) : nullptr;
+                if (!entry) {
+                    continue;
+                }
+                batch.entries.push_back(entry);
+                auto multipliers = multipliersFor(shout);
+                batch.multipliers.push_back(multipliers);
+                const auto* begin = snapshot->records.data() + entry->first;
+                for (const auto* record = begin; record != begin + entry->count; ++record) {
+                    batch.values.push_back(ScaleRecord(*record, multipliers));
+                }
+            }
+        }
+
+        // Writes a prepared batch and marks its shouts applied, as Apply would. Must run where Apply runs. Returns
+        // the number of records written; shouts already holding the batch's values are skipped.
+        std::uint32_t Commit(const Batch& batch) {
+            // Shares are read from the current snapshot: a shout compiled since Prepare may share the batch's targets
+            const auto* current = _snapshot.Load();
+            const auto* value = batch.values.data();
+            const auto* multipliers = batch.multipliers.data();
+            std::uint32_t written = 0;
+
+            for (const auto* entry : batch.entries) {
+                auto& state = *entry->state;
+                const auto* shares = current == batch.snapshot ? entry : current->Find(entry->shout);
+                if (state.stamp.load(std::memory_order_relaxed) == batch.stamp &&
+                    Holds(*current, *shares, multipliers)) {
+                    value += entry->count;
+                    multipliers++;
+                    continue;
+                }
+
+                const auto* records = batch.snapshot->records.data() + entry->first;
+                for (std::uint32_t i = 0; i < entry->count; i++) {
+                    StoreValue(records[i], value[i]);
+                }
+                value += entry->count;
+                written += entry->count;
+
+                SetStamp(entry->shout, state, batch.stamp);
+                Claim(*current, *shares, multipliers++);
+            }
+            return written;
+        }
+
+        // The shout a voice spell belongs to, or nullptr. Only shouts compiled into the plan are known.
+        Shout* FindShoutBySpell(const Spell* spell) const {
+            const auto* snapshot = _snapshot.Load();
+            if (!snapshot) {
+                return nullptr;
+            }
+
+            auto it = std::lower_bound(snapshot->spells.begin(), snapshot->spells.end(), spell,
+                                       [](const SpellEntry& entry, const Spell* key) { return entry.spell < key; });
+            return it != snapshot->spells.end() && it->spell == spell ? it->shout : nullptr;
+        }
+
+        // Calls visit(shout, stamp) for every shout whose forms hold scaled values, in no particular order. Walks the
+        // applied set only, not the plan. Must run where Apply runs.
+        template <class F>
+        void ForEachApplied(F&& visit) const {
+            for (const auto& applied : _applied) {
+                visit(applied.shout, applied.state->stamp.load(std::memory_order_relaxed));
+            }
+        }
+
+        // A shout a recorded state has scaled, and the souls it was scaled for
+        struct Target {
+            Shout* shout;
+            int souls;
+        };
+
+        struct ReconcileStats {
+            std::uint32_t restored;  // shouts restored because the recorded state has them vanilla
+            std::uint32_t applied;   // shouts rescaled because they held other values
+            std::uint32_t written;   // records written by both
+        };
+
+        // Brings the forms to a recorded state: every shout in `targets` scaled for its souls under `generation`, and
+        // every other shout vanilla. `multipliersFor(shout, souls)` gives the multipliers. Only the applied set and
+        // the targets are visited, so the cost follows the number of scaled shouts rather than the size of the plan.
+        // Shouts whose stamp already matches are skipped, so reconciling to the state the forms already hold writes
+        // nothing. Only stamps are compared: shared targets can hold one shout's values at a time, and Apply
+        // rewrites them at the next cast of a shout that finds another shout's values there. Must run where Apply
+        // runs.
+        template <class F>
+        ReconcileStats Reconcile(std::span<Target> targets, std::uint32_t generation, F&& multipliersFor) {
+            ReconcileStats stats{};
+            // Marks every target the forms already hold, and keeps the applied targets from being restored
+            const auto* snapshot = _snapshot.Load();
+            _pending.clear();
+            for (const auto& target : targets) {
+                const auto* entry = snapshot ? snapshot->Find(target.shout) : nullptr;
+                if (entry) {
+                    entry->state->kept = true;
+                    if (entry->state->stamp.load(std::memory_order_relaxed) == MakeStamp(generation, target.souls)) {
+                        continue;
+                    }
+                }
+                _pending.push_back(&target);
+            }
+
+            // Backwards, because a restore moves the last applied shout into the restored one's slot
+            for (auto i = _applied.size(); i-- > 0;) {
+                auto& state = *_applied[i].state;
+                if (state.kept) {
+                    state.kept = false;
+                    continue;
+                }
+                auto write = Restore(_applied[i].shout);
+                stats.restored++;
+                stats.written += write.written;
+            }
+
+            for (const auto* target : _pending) {
+                auto write = Apply(target->shout, multipliersFor(target->shout, target->souls),
+                                   MakeStamp(generation, target->souls));
+                if (write.written != 0) {
+                    stats.applied++;
+                    stats.written += write.written;
+                }
+                // A target that was not applied before keeps its mark until here
+                if (const auto* entry = snapshot ? snapshot->Find(target->shout) : nullptr) {
+                    entry->state->kept = false;
+                }
+            }
+            return stats;
+        }
+
+        const Snapshot* GetSnapshot() const { return _snapshot.Load(); }
+
+        std::size_t GetMemoryFootprint() const {
+            const auto* snapshot = _snapshot.Load();
+            return snapshot ? snapshot->GetMemoryFootprint() : 0;
+        }
+
+        CacheStats GetCacheStats() const {
+            return { _applyHits.load(std::memory_order_relaxed), _applyMisses.load(std::memory_order_relaxed),
+                     _restoreHits.load(std::memory_order_relaxed), _restoreMisses.load(std::memory_order_relaxed) };
+        }
+
+    private:
+        struct Lookup {
+            const Snapshot* snapshot;
+            const Entry* entry;
+            bool compiled;
+        };
+
+        // Reads the forms only, so slices can be compiled concurrently. The caller assigns entry.state.
+        //
+        // `seen` collects the targets already emitted for this shout: shared projectiles (and the odd spell reused
+        // across variations) must be written only once, otherwise the second write would scale an already-scaled
+        // value. It is scratch space, cleared here, so callers keep one across shouts instead of allocating per shout.
+        Entry Compile(Shout* shout, Records& records, Targets& seen, std::vector<RecordKey>* keys = nullptr) {
+            Entry entry{ shout, nullptr, static_cast<std::uint32_t>(records.size()), 0, 0, 0, 0, 0 };
+            seen.clear();
+
+            auto emit = [&](auto* target, Transform transform, std::uint32_t owner, std::uint16_t index, Field field) {
+                if (std::find(seen.begin(), seen.end(), target) != seen.end()) {
+                    return false;
+                }
+                seen.push_back(target);
+                auto original = static_cast<float>(*target);
+                records.push_back({ target, original, transform });
+                if (keys) {
+                    keys->push_back({ owner, index, field, static_cast<std::uint8_t>(transform), original });
+                }
+                return true;
+            };
+
+            auto shoutID = Forms::GetFormID(shout);
+            std::uint16_t variationIndex = 0;
+            for (auto& variation : shout->variations) {
+                emit(&variation.recoveryTime, Transform::kCooldown, shoutID, variationIndex++, Field::kRecoveryTime);
+            }
+
+            for (auto& variation : shout->variations) {
+                if (!variation.spell) {
+                    continue;
+                }
+                auto spellID = Forms::GetFormID(variation.spell);
+                std::uint16_t effectIndex = 0;
+                for (auto* effect : variation.spell->effects) {
+                    auto index = effectIndex++;
+                    if (!effect || !effect->baseEffect) {
+                        continue;
+                    }
+
+                    // Zero durations and areas (instant, single target) are left out: scaling them changes nothing
+                    auto scaling = GetArchetypeScaling(Forms::GetArchetype(effect->baseEffect));
+                    auto& item = effect->effectItem;
+                    bool scaled = false;
+                    if (scaling & (kScaleMagnitude | kScaleMagnitudeInverse)) {
+                        auto transform =
+                            (scaling & kScaleMagnitudeInverse) ? Transform::kMagnitudeInverse : Transform::kMagnitude;
+                        scaled |= emit(&item.magnitude, transform, spellID, index, Field::kMagnitude);
+                    }
+                    if ((scaling & kScaleDuration) && item.duration != 0) {
+                        scaled |= emit(&item.duration, Transform::kDuration, spellID, index, Field::kDuration);
+                    }
+                    if ((scaling & kScaleArea) && item.area != 0) {
+                        scaled |= emit(&item.area, Transform::kArea, spellID, index, Field::kArea);
+                    }
+                    if (scaled) {
+                        entry.effects++;
+                    }
+
+                    auto* projectile = effect->baseEffect->data.projectileBase;
+                    if (!projectile) {
+                        continue;
+                    }
+                    auto projectileID = Forms::GetFormID(projectile);
+                    if (emit(&projectile->data.speed, Transform::kDistance, projectileID, 0, Field::kProjectileSpeed)) {
+                        emit(&projectile->data.range, Transform::kDistance, projectileID, 0, Field::kProjectileRange);
+                        entry.projectiles++;
+                    }
+                }
+            }
+
+            entry.count = static_cast<std::uint32_t>(records.size()) - entry.first;
+            return entry;
+        }
+
+        const Snapshot* Publish(std::unique_ptr<Snapshot> snapshot, const PlanCacheView* cache = nullptr) {
+            std::sort(snapshot->entries.begin(), snapshot->entries.end(),
+                      [](const Entry& a, const Entry& b) { return a.shout < b.shout; });
+            std::sort(snapshot->spells.begin(), snapshot->spells.end(),
+                      [](const SpellEntry& a, const SpellEntry& b) { return a.spell < b.spell; });
+            if (cache) {
+                IndexShared(*snapshot, *cache);
+            } else {
+                IndexShared(*snapshot, 0);
+            }
+
+            snapshot->records.shrink_to_fit();
+            snapshot->entries.shrink_to_fit();
+            snapshot->spells.shrink_to_fit();
+            snapshot->shared.shrink_to_fit();
+
+            return _snapshot.Publish(std::move(snapshot));
+        }
+
+        // The token each transform leaves in a shared target, indexed by Transform
+        using Tokens = std::array<std::uint64_t, 6>;
+
+        static_assert(std::tuple_size_v<Tokens> == static_cast<std::size_t>(Transform::kArea) + 1);
+
+        static Tokens TokensFor(const Multipliers* multipliers) {
+            if (!multipliers) {
+                return {};  // RESTORED_TOKEN
+            }
+            auto token = [](float multiplier) {
+                return (std::uint64_t{ 1 } << 32) | std::bit_cast<std::uint32_t>(multiplier);
+            };
+            auto distance = token(multipliers->distance);
+            auto magnitude = token(multipliers->magnitude);
+            return { token(multipliers->cooldown), magnitude, magnitude, distance, magnitude, distance };
+        }
+
+        // Whether every target `entry` shares still holds what `multipliers` (nullptr: the originals) produce
+        static bool Holds(const Snapshot& snapshot, const Entry& entry, const Multipliers* multipliers) {
+            if (entry.sharedCount == 0) {
+                return true;
+            }
+            auto tokens = TokensFor(multipliers);
+            const auto* shared = snapshot.shared.data() + entry.sharedFirst;
+            for (std::uint32_t i = 0; i < entry.sharedCount; i++) {
+                if (shared[i].target->token.load(std::memory_order_relaxed) !=
+                    tokens[static_cast<std::size_t>(shared[i].transform)]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Records that `entry` just wrote its shared targets, which invalidates every other shout sharing them
+        static void Claim(const Snapshot& snapshot, const Entry& entry, const Multipliers* multipliers) {
+            auto tokens = TokensFor(multipliers);
+            const auto* shared = snapshot.shared.data() + entry.sharedFirst;
+            for (std::uint32_t i = 0; i < entry.sharedCount; i++) {
+                shared[i].target->token.store(tokens[static_cast<std::size_t>(shared[i].transform)],
+                                              std::memory_order_relaxed);
+            }
+        }
+
+        // Finds the targets written by more than one shout and lists them per entry. Targets that were already
+        // shared keep their SharedTarget, and so their token.
+        //
+        // Records from `firstNew` on were just compiled into an existing plan (0: the plan is new). Their originals
+        // were read from the live forms, which for a target an already-compiled shout also writes may hold that
+        // shout's scaled value, so they are replaced with the existing record's original. A new plan holds vanilla
+        // forms and its shared targets start restored; a target that becomes shared later starts unknown, so the next
+        // write of any shout sharing it goes through.
+        void IndexShared(Snapshot& snapshot, std::size_t firstNew) {
+            const bool fresh = firstNew == 0;
+            auto& records = snapshot.records;
+            std::vector<std::pair<const void*, std::uint32_t>> byTarget(records.size());
+            for (std::uint32_t i = 0; i < records.size(); i++) {
+                byTarget[i] = { records[i].target, i };
+            }
+            std::sort(byTarget.begin(), byTarget.end());
+            auto groupEnd = [&byTarget](std::size_t begin) {
+                auto end = begin + 1;
+                while (end < byTarget.size() && byTarget[end].first == byTarget[begin].first) {
+                    end++;
+                }
+                return end;
+            };
+
+            std::vector<SharedTarget*> targets(records.size(), nullptr);
+            for (const auto& shared : snapshot.shared) {
+                targets[shared.record] = shared.target;
+            }
+
+            if (fresh) {
+                std::size_t groups = 0;
+                for (std::size_t begin = 0, end; begin < byTarget.size(); begin = end) {
+                    end = groupEnd(begin);
+                    groups += end - begin > 1;
+                }
+                _shared.Reserve(groups);
+            }
+
+            for (std::size_t begin = 0, end; begin < byTarget.size(); begin = end) {
+                end = groupEnd(begin);
+                if (end - begin == 1) {
+                    continue;
+                }
+                SharedTarget* target = nullptr;
+                for (auto i = begin; i < end && !target; i++) {
+                    target = targets[byTarget[i].second];
+                }
+                if (!target) {
+                    target = &_shared.Emplace();
+                    target->token.store(fresh ? RESTORED_TOKEN : UNKNOWN_TOKEN, std::memory_order_relaxed);
+                }
+
+                // Sorted by index within the group, so an existing record comes first
+                auto existing = byTarget[begin].second;
+                for (auto i = begin; i < end; i++) {
+                    auto record = byTarget[i].second;
+                    targets[record] = target;
+                    if (record >= firstNew && existing < firstNew) {
+                        records[record].original = records[existing].original;
+                    }
+                }
+            }
+
+            ListShared(snapshot, targets);
+        }
+
+        // A fresh IndexShared from the groups a cache recorded, so no record has to be sorted by target
+        void IndexShared(Snapshot& snapshot, const PlanCacheView& cache) {
+            _shared.Reserve(cache.Groups());
+            std::vector<SharedTarget*> groups(cache.Groups());
+            for (auto& group : groups) {
+                group = &_shared.Emplace();
+                group->token.store(RESTORED_TOKEN, std::memory_order_relaxed);
+            }
+            std::vector<SharedTarget*> targets(snapshot.records.size(), nullptr);
+            for (const auto& share : cache.Shares()) {
+                targets[share.record] = groups[share.group];
+            }
+            ListShared(snapshot, targets);
+        }
+
+        // Builds every entry's list of shared records from `targets`, parallel to the records
+        static void ListShared(Snapshot& snapshot, const std::vector<SharedTarget*>& targets) {
+            snapshot.shared.clear();
+            for (auto& entry : snapshot.entries) {
+                entry.sharedFirst = static_cast<std::uint32_t>(snapshot.shared.size());
+                for (auto record = entry.first; record < entry.first + entry.count; record++) {
+                    if (targets[record]) {
+                        snapshot.shared.push_back({ targets[record], record, snapshot.records[record].transform });
+                    }
+                }
+                entry.sharedCount = static_cast<std::uint32_t>(snapshot.shared.size()) - entry.sharedFirst;
+            }
+        }
+
+        // Numbers the shared targets of a freshly built snapshot into the cache's groups
+        static void RecordShares(const Snapshot& snapshot, PlanCacheData& cache) {
+            std::unordered_map<const SharedTarget*, std::uint32_t> groups;
+            cache.shares.clear();
+            cache.shares.reserve(snapshot.shared.size());
+            for (const auto& shared : snapshot.shared) {
+                auto group = groups.try_emplace(shared.target, static_cast<std::uint32_t>(groups.size())).first;
+                cache.shares.push_back({ shared.record, group->second });
+            }
+            cache.groups = static_cast<std::uint32_t>(groups.size());
+        }
+
+        // Everything Compile's choice of records depends on apart from the values: the variation spells, and for each
+        // effect its archetype, whether its duration and area are zero, and its projectile. Walks the same forms as
+        // Compile but emits nothing, so checking a cached shout costs a fraction of compiling it.
+        static std::uint32_t HashTopology(Shout* shout) {
+            auto hash = FNV_OFFSET;
+            for (auto& variation : shout->variations) {
+                auto spellID = variation.spell ? Forms::GetFormID(variation.spell) : 0;
+                hash = Fnv1a(&spellID, sizeof(spellID), hash);
+                if (!variation.spell) {
+                    continue;
+                }
+                auto effects = static_cast<std::uint32_t>(variation.spell->effects.size());
+                hash = Fnv1a(&effects, sizeof(effects), hash);
+                for (auto* effect : variation.spell->effects) {
+                    std::uint32_t shape[4]{};
+                    if (effect && effect->baseEffect) {
+                        auto* projectile = effect->baseEffect->data.projectileBase;
+                        shape[0] = Forms::GetArchetype(effect->baseEffect) + 1;
+                        shape[1] = effect->effectItem.duration != 0;
+                        shape[2] = effect->effectItem.area != 0;
+                        shape[3] = projectile ? Forms::GetFormID(projectile) : 0;
+                    }
+                    hash = Fnv1a(shape, sizeof(shape), hash);
+                }
+            }
+            return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+        }
+
+        void ResetStates(std::size_t count) {
+            _states.Reserve(count);
+            _applied.clear();
+            _applied.reserve(count);
+            _pending.reserve(count);
+        }
+
+        // Stores the stamp and keeps the applied set in step with it
+        void SetStamp(Shout* shout, AppliedState& state, std::uint64_t stamp) {
+            bool wasApplied = state.stamp.load(std::memory_order_relaxed) != RESTORED;
+            state.stamp.store(stamp, std::memory_order_relaxed);
+            if (stamp != RESTORED && !wasApplied) {
+                state.applied = static_cast<std::uint32_t>(_applied.size());
+                _applied.push_back({ shout, &state });
+            } else if (stamp == RESTORED && wasApplied) {
+                auto slot = state.applied;
+                _applied[slot] = _applied.back();
+                _applied[slot].state->applied = slot;
+                _applied.pop_back();
+                state.applied = NOT_APPLIED;
+            }
+        }
+
+        static void IndexSpells(Shout* shout, SpellEntries& spells) {
+            for (auto& variation : shout->variations) {
+                if (variation.spell) {
+                    spells.push_back({ variation.spell, shout });
+                }
+            }
+        }
+
+        Lookup FindOrCompile(Shout* shout) {
+            const auto* snapshot = _snapshot.Load();
+            if (snapshot) {
+                if (const auto* entry = snapshot->Find(shout)) {
+                    return { snapshot, entry, false };
+                }
+            }
+
+            // Form that did not exist at build time (e.g. created at runtime). Its own values are captured now, before
+            // anything has scaled them; targets it shares with compiled shouts (a projectile they already scaled) take
+            // the original of the existing record instead, in IndexShared. Readers keep using the old snapshot until
+            // the copy is published.
+            bool compiled = false;
+            snapshot = _snapshot.Update([this, shout, &compiled](Snapshot& next) {
+                if (next.Find(shout)) {
+                    return false;
+                }
+                Targets seen;
+                auto firstNew = next.records.size();
+                auto entry = Compile(shout, next.records, seen);
+                entry.state = &_states.Emplace();
+                _applied.reserve(next.entries.size() + 1);
+                auto it = std::lower_bound(next.entries.begin(), next.entries.end(), shout,
+                                           [](const Entry& e, const Shout* key) { return e.shout < key; });
+                next.entries.insert(it, entry);
+
+                IndexSpells(shout, next.spells);
+                std::sort(next.spells.begin(), next.spells.end(),
+                          [](const SpellEntry& a, const SpellEntry& b) { return a.spell < b.spell; });
+                IndexShared(next, firstNew);
+                compiled = true;
+                return true;
+            });
+
+            return { snapshot, snapshot->Find(shout), compiled };
+        }
+
+        Published<Snapshot> _snapshot;
+        // Appended only by the plan writer, and never shrunk: each build reserves a new block, so snapshots retired
+        // by a later build keep valid states
+        Pool<AppliedState, Subsystem::kAppliedState> _states;
+        Pool<SharedTarget, Subsystem::kAppliedState> _shared;
+
+        // The shouts whose stamp is not RESTORED, in no order; written only where Apply runs
+        struct Applied {
+            Shout* shout;
+            AppliedState* state;
+        };
+        TrackedVector<Applied, Subsystem::kAppliedState> _applied;
+        TrackedVector<const Target*, Subsystem::kAppliedState> _pending;  // Reconcile's targets to apply
+
+        std::atomic<std::uint64_t> _applyHits{ 0 };
+        std::atomic<std::uint64_t> _applyMisses{ 0 };
+        std::atomic<std::uint64_t> _restoreHits{ 0 };
+        std::atomic<std::uint64_t> _restoreMisses{ 0 };
+    };
+}
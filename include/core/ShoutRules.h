@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "Archetypes.h"
+#include "Curves.h"
+#include "FlatFormMap.h"
+#include "ShoutPlan.h"
+
+// Per-shout overrides of the global multipliers, compiled into a FormID table.
+//
+// A rule can stop a multiplier from scaling, clamp it, or replace its curve. Rules select shouts by FormID (the
+// loader resolves plugin + local FormID and editor IDs) or by the archetype of any of the shout's effects. Compiling
+// assigns every matched shout its winning rule up front: FormID selectors beat archetype selectors, and within a kind
+// the earlier rule wins. The cast path then does one FlatFormMap lookup and never sees a selector.
+namespace Core {
+    struct RuleChannel {
+        bool scale = true;        // false: the multiplier stays at 1.0
+        float min = -1.0e30f;     // clamps applied after the curve
+        float max = 1.0e30f;
+        std::int32_t curve = -1;  // index into the rule set's curve tables, -1 = the global curve
+    };
+
+    struct ShoutRule {
+        RuleChannel distance;
+        RuleChannel magnitude;
+        RuleChannel cooldown;
+    };
+
+    struct RuleSelector {
+        enum class Kind : std::uint8_t {
+            kFormID,
+            kArchetype
+        };
+
+        Kind kind;
+        std::uint32_t value;  // FormID or Core::Archetype
+        std::uint32_t rule;   // index into the rules
+    };
+
+    class ShoutRules {
+    public:
+        static constexpr std::uint32_t NO_RULE = UINT32_MAX;
+
+        using ArchetypeRules = std::array<std::uint32_t, static_cast<std::size_t>(Archetype::kTotal)>;
+
+        // `shouts` is every shout in the load order, walked only when some selector is an archetype
+        template <class Forms, class Range>
+        void Compile(std::vector<ShoutRule> rules, std::vector<Curves::MultiplierTable> curves,
+                     const std::vector<RuleSelector>& selectors, const Range& shouts) {
+            _rules.assign(rules.begin(), rules.end());
+            _curves.assign(std::make_move_iterator(curves.begin()), std::make_move_iterator(curves.end()));
+
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> entries;
+            ArchetypeRules byArchetype;
+            byArchetype.fill(NO_RULE);
+            bool anyArchetype = false;
+
+            for (const auto& selector : selectors) {
+                if (selector.kind == RuleSelector::Kind::kFormID) {
+                    entries.emplace_back(selector.value, selector.rule);
+                } else if (selector.value < byArchetype.size()) {
+                    auto& rule = byArchetype[selector.value];
+                    rule = std::min(rule, selector.rule);
+                    anyArchetype = true;
+                }
+            }
+
+            // FormID entries are already in, so FlatFormMap keeps them over these
+            if (anyArchetype) {
+                for (auto* shout : shouts) {
+                    auto rule = shout ? MatchArchetypes<Forms>(shout, byArchetype) : NO_RULE;
+                    if (rule != NO_RULE) {
+                        entries.emplace_back(Forms::GetFormID(shout), rule);
+                    }
+                }
+            }
+
+            _map.Build(entries);
+        }
+
+        const ShoutRule* Find(std::uint32_t formID) const {
+            const auto* index = _map.Find(formID);
+            return index ? &_rules[*index] : nullptr;
+        }
+
+        Multipliers Apply(const ShoutRule& rule, const Multipliers& global, int souls) const {
+            return { Channel(rule.distance, global.distance, souls), Channel(rule.magnitude, global.magnitude, souls),
+                     Channel(rule.cooldown, global.cooldown, souls) };
+        }
+
+        std::size_t GetRuleCount() const { return _rules.size(); }
+        std::size_t GetShoutCount() const { return _map.Size(); }
+        std::size_t GetMemoryFootprint() const {
+            std::size_t bytes = _map.GetMemoryFootprint() + _rules.capacity() * sizeof(ShoutRule);
+            for (const auto& curve : _curves) {
+                bytes += sizeof(curve) + curve.GetMemoryFootprint();
+            }
+            return bytes;
+        }
+
+    private:
+        // The earliest rule among the archetypes of the shout's effects
+        template <class Forms, class Shout>
+        static std::uint32_t MatchArchetypes(Shout* shout, const ArchetypeRules& byArchetype) {
+            auto best = NO_RULE;
+            for (auto& variation : shout->variations) {
+                if (!variation.spell) {
+                    continue;
+                }
+                for (auto* effect : variation.spell->effects) {
+                    if (effect && effect->baseEffect) {
+                        auto archetype = Forms::GetArchetype(effect->baseEffect);
+                        if (archetype < byArchetype.size()) {
+                            best = std::min(best, byArchetype[archetype]);
+                        }
+                    }
+                }
+            }
+            return best;
+        }
+
+        float Channel(const RuleChannel& channel, float global, int souls) const {
+            if (!channel.scale) {
+                return 1.0f;
+            }
+            auto value = channel.curve >= 0 ? _curves[static_cast<std::size_t>(channel.curve)].Lookup(souls) : global;
+            return std::clamp(value, channel.min, channel.max);
+        }
+
+        TrackedVector<ShoutRule, Subsystem::kRules> _rules;
+        TrackedVector<Curves::MultiplierTable, Subsystem::kRules> _curves;
+        FlatFormMap<std::uint32_t> _map;
+    };
+}
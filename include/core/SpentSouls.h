@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Form-independent half of SoulCounter: counting known words and caching the total between word events.
+// See include/core/ShoutPlan.h for what `Forms` provides.
+namespace Core {
+    template <class Forms>
+    int CountKnownWords(const typename Forms::Shout* shout) {
+        int words = 0;
+        for (const auto& variation : shout->variations) {
+            if (variation.word && Forms::IsWordKnown(variation.word)) {
+                words++;
+            }
+        }
+        return words;
+    }
+
+    template <class Forms>
+    int CountKnownWords(typename Forms::Shout* const* shouts, std::uint32_t count) {
+        int words = 0;
+        for (std::uint32_t i = 0; i < count; i++) {
+            if (shouts[i]) {
+                words += CountKnownWords<Forms>(shouts[i]);
+            }
+        }
+        return words;
+    }
+
+    // Signature of a shout list: its size and an XOR of its mixed form pointers. It changes when a shout is added,
+    // removed or replaced by another, whatever the order of the list. Pointers identify forms as well as FormIDs do
+    // while the game runs, and hashing them reads only the list, not every shout it points to.
+    template <class Shout>
+    std::uint64_t HashShoutList(Shout* const* shouts, std::uint32_t count) {
+        std::uint64_t signature = count;
+        for (std::uint32_t i = 0; i < count; i++) {
+            auto address = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(shouts[i]));
+            signature ^= address * 0x9E3779B97F4A7C15ull;
+        }
+        return signature;
+    }
+
+    // Spent-soul total that is recounted only when marked dirty or when the signature of the player's shout list
+    // (HashShoutList) changes. Shouts can be added or removed by scripts and the console without any event, and
+    // removing one while adding another leaves the size unchanged, so the signature covers which shouts are listed.
+    class SpentSoulCache {
+    public:
+        void MarkDirty() { _dirty.store(true, std::memory_order_relaxed); }
+
+        // `recount` is called (with no arguments) when the cached total is stale
+        template <class F>
+        int Get(std::uint64_t shoutList, F&& recount) {
+            if (shoutList != _shoutList.load(std::memory_order_relaxed)) {
+                _shoutList.store(shoutList, std::memory_order_relaxed);
+                _dirty.store(true, std::memory_order_relaxed);
+            }
+
+            if (_dirty.exchange(false, std::memory_order_acq_rel)) {
+                _spentSouls.store(recount(), std::memory_order_relaxed);
+            }
+
+            return _spentSouls.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<int> _spentSouls{ 0 };
+        std::atomic<std::uint64_t> _shoutList{ 0 };
+        std::atomic<bool> _dirty{ true };
+    };
+}
@@ -2,8 +2,16 @@
 #include <SKSE/SKSE.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
+#include "BatchScaler.h"
 #include "Config.h"
+#include "Metrics.h"
+#include "Papyrus.h"
+#include "PerCastScaler.h"
+#include "ScalingPlan.h"
+#include "Serialization.h"
 #include "ShoutHandler.h"
+#include "SoulCounter.h"
+#include "TraceLog.h"
 
 using namespace std::literals;
 
@@ -32,23 +40,56 @@ void OnSKSEMessage(SKSE::MessagingInterface::Message* message) {
     if (message->type == SKSE::MessagingInterface::kDataLoaded) {
         SKSE::log::info("Data loaded, registering event handlers...");
 
-        auto* config = Config::GetSingleton();
-        config->LoadFromINI();
+        auto* config = Config::Load();
 
+        auto traceMode = TraceLog::Mode::kSynchronous;
         if (config->bEnableDebugLogging) {
             spdlog::set_level(spdlog::level::debug);
             SKSE::log::info("Debug logging enabled");
+            traceMode = static_cast<TraceLog::Mode>(std::clamp(config->iDebugLogMode, 0, 2));
         }
 
-        auto* actionEventSource = SKSE::GetActionEventSource();
-        if (actionEventSource) {
-            actionEventSource->AddEventSink(ShoutHandler::GetSingleton());
-            SKSE::log::info("Action event handler registered successfully");
+        if (traceMode != TraceLog::Mode::kSynchronous) {
+            // The trace writer flushes once per batch, so the text log no longer needs to flush on every line
+            spdlog::flush_on(spdlog::level::warn);
+        }
+        if (traceMode != TraceLog::Mode::kSynchronous || config->bCaptureShoutEvents) {
+            TraceLog::GetSingleton()->Start(traceMode, *SKSE::log::log_directory(), config->bCaptureShoutEvents);
+        }
+
+        Metrics::SetEnabled(config->bEnableMetrics);
+
+        ScalingPlan::GetSingleton()->Build();
+        SoulCounter::GetSingleton()->Register();
+        BatchScaler::GetSingleton()->Register();
+
+        if (config->bPerCastScaling) {
+            PerCastScaler::GetSingleton()->Install();
+        }
+
+        // Everything long-lived is allocated by now; later growth shows up in the metrics dump
+        Metrics::DumpMemory();
+
+        if (config->bUseShoutHook) {
+            ShoutHandler::InstallHook();
         } else {
-            SKSE::log::error("Failed to get ActionEvent event source");
+            auto* actionEventSource = SKSE::GetActionEventSource();
+            if (actionEventSource) {
+                actionEventSource->AddEventSink(ShoutHandler::GetSingleton());
+                SKSE::log::info("Action event handler registered successfully");
+            } else {
+                SKSE::log::error("Failed to get ActionEvent event source");
+            }
         }
 
+        Config::StartWatching();
+
         SKSE::log::info("Shout Progression plugin initialized successfully");
+    } else if (message->type == SKSE::MessagingInterface::kPostLoadGame ||
+               message->type == SKSE::MessagingInterface::kNewGame) {
+        Serialization::GetSingleton()->OnGameLoaded();
+        SoulCounter::GetSingleton()->Reseed();
+        BatchScaler::GetSingleton()->Schedule();
     }
 }
 
@@ -70,6 +111,15 @@ SKSEPluginLoad(const SKSE::LoadInterface* skse) {
         return false;
     }
 
+    Serialization::GetSingleton()->Register();
+
+    auto* papyrus = SKSE::GetPapyrusInterface();
+    if (papyrus && papyrus->Register(Papyrus::Register)) {
+        SKSE::log::info("Registered Papyrus functions");
+    } else {
+        SKSE::log::error("Failed to register Papyrus functions");
+    }
+
     SKSE::log::info("{} has finished loading.", plugin->GetName());
     return true;
 }
@@ -0,0 +1,129 @@
+#include "BatchScaler.h"
+#include "Config.h"
+#include "ShoutHandler.h"
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+#include <chrono>
+#include <thread>
+
+BatchScaler* BatchScaler::GetSingleton() {
+    static BatchScaler singleton;
+    return &singleton;
+}
+
+void BatchScaler::Register() {
+    if (auto* source = RE::DragonSoulsGained::GetEventSource()) {
+        source->AddEventSink<RE::DragonSoulsGained::Event>(this);
+    } else {
+        SKSE::log::warn("Failed to get DragonSoulsGained event source, absorbed souls are applied on the next cast");
+    }
+
+    // Detached: the worker only waits for jobs, and the process tears it down on exit
+    std::thread([this]() { Run(); }).detach();
+
+    SKSE::log::info("Batch scaler registered");
+}
+
+void BatchScaler::Schedule() {
+    _requests.fetch_add(1, std::memory_order_acq_rel);
+
+    // The queued gather reads the request counter when it runs, so it covers every request made before then
+    if (_gatherQueued.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    auto* tasks = SKSE::GetTaskInterface();
+    if (!tasks) {
+        _gatherQueued.store(false, std::memory_order_release);
+        return;
+    }
+    tasks->AddTask([this]() { Gather(); });
+}
+
+void BatchScaler::Gather() {
+    _gatherQueued.store(false, std::memory_order_release);
+    auto request = _requests.load(std::memory_order_acquire);
+
+    const auto* config = Config::GetSingleton();
+    if (!config->bBatchScaling || config->bPerCastScaling) {
+        return;
+    }
+
+    auto* player = RE::PlayerCharacter::GetSingleton();
+    auto* base = player ? player->GetActorBase() : nullptr;
+    auto* effects = base ? base->actorEffects : nullptr;
+    if (!effects || !effects->shouts || effects->numShouts == 0) {
+        return;
+    }
+
+    std::unique_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        job = std::move(_spare);
+    }
+    if (!job) {
+        job = std::make_unique<Job>();
+    }
+
+    auto souls = ShoutHandler::GetSingleton()->ReadSouls(player, config);
+    job->request = request;
+    job->totalSouls = souls.unspent + souls.spent;
+    job->config = config;
+    job->stamp = ScalingPlan::MakeStamp(config->generation, job->totalSouls);
+    job->shouts.assign(effects->shouts, effects->shouts + effects->numShouts);
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _pending = std::move(job);
+    }
+    _wake.notify_one();
+}
+
+void BatchScaler::Run() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _wake.wait(lock, [this]() { return _pending != nullptr; });
+            job = std::move(_pending);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto* handler = ShoutHandler::GetSingleton();
+        auto multipliersFor = [handler, &job](const RE::TESShout* shout) {
+            return handler->GetMultipliers(job->config, shout, job->totalSouls);
+        };
+        ScalingPlan::GetSingleton()->Prepare(job->shouts, multipliersFor, job->stamp, job->batch);
+        job->prepareNanoseconds = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+        // Task callbacks are copied, so the job travels as a raw pointer and is owned again in Commit
+        auto* raw = job.release();
+        SKSE::GetTaskInterface()->AddTask([this, raw]() { Commit(std::unique_ptr<Job>(raw)); });
+    }
+}
+
+void BatchScaler::Commit(std::unique_ptr<Job> job) {
+    // A newer request is already on its way and will write its own values
+    if (job->request == _requests.load(std::memory_order_acquire)) {
+        auto start = std::chrono::steady_clock::now();
+        auto written = ScalingPlan::GetSingleton()->Commit(job->batch);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        if (Config::GetSingleton()->bEnableDebugLogging) {
+            SKSE::log::info("Batch scaled {} shouts for {} souls: {} records written, prepared in {} us, committed in "
+                            "{} us",
+                            job->batch.entries.size(), job->totalSouls, written, job->prepareNanoseconds / 1000,
+                            elapsed.count());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _spare = std::move(job);
+}
+
+RE::BSEventNotifyControl BatchScaler::ProcessEvent(const RE::DragonSoulsGained::Event*,
+                                                   RE::BSTEventSource<RE::DragonSoulsGained::Event>*) {
+    Schedule();
+    return RE::BSEventNotifyControl::kContinue;
+}
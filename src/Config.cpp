@@ -1,44 +1,170 @@
 #include "Config.h"
+#include "BatchScaler.h"
+#include "Metrics.h"
+#include "RulesFile.h"
+#include "Snapshot.h"
 #include <RE/Skyrim.h>
 #include <SKSE/SKSE.h>
 #include <SimpleIni.h>
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <mutex>
+#include <thread>
 
 Config::Config() {
 
 }
 
-Config* Config::GetSingleton() {
-    static Config instance;
-    return &instance;
+namespace {
+    Published<Config>& Storage() {
+        static Published<Config> storage;
+        return storage;
+    }
+
+    // Configs replaced by a reload that stay allocated. A reader keeps a snapshot for one cast or one batch job,
+    // which is done within a couple of frames, and reloads run at most once per frame (queued reloads fold together),
+    // so a config several reloads old can no longer be in use.
+    constexpr std::size_t RETAINED_CONFIGS = 8;
+
+    std::mutex g_loadLock;
+    std::atomic<bool> g_reloadQueued{ false };
+    std::uint32_t g_generation = 0;
+    std::filesystem::file_time_type g_loadedWriteTime{};
+
+    std::filesystem::path FindConfigPath() {
+        auto mcmUserPath = std::filesystem::path("Data") / "MCM" / "Settings" / "ShoutProgression - MCM.ini";
+        auto mcmDefaultPath = std::filesystem::path("Data") / "MCM" / "Config" / "ShoutProgression - MCM" / "settings.ini";
+        auto legacyPath = std::filesystem::path("Data") / "SKSE" / "Plugins" / "ShoutProgression.ini";
+
+        for (const auto& path : { mcmUserPath, mcmDefaultPath, legacyPath }) {
+            if (std::filesystem::exists(path)) {
+                return path;
+            }
+        }
+        return {};
+    }
+
+    // Write time of whichever file Load() would read; changes when MCM Helper saves or creates the user settings
+    std::filesystem::file_time_type CurrentWriteTime() {
+        std::error_code error;
+        auto path = FindConfigPath();
+        auto time = path.empty() ? std::filesystem::file_time_type{} : std::filesystem::last_write_time(path, error);
+        return error ? std::filesystem::file_time_type{} : time;
+    }
+
+    // Settings that are read when their subsystem is used rather than at data load
+    void ApplyRuntimeSettings(const Config* previous, const Config& next) {
+        if (previous->bEnableDebugLogging != next.bEnableDebugLogging) {
+            spdlog::set_level(next.bEnableDebugLogging ? spdlog::level::debug : spdlog::level::info);
+        }
+        if (previous->bEnableMetrics != next.bEnableMetrics) {
+            Metrics::SetEnabled(next.bEnableMetrics);
+        }
+    }
 }
 
-void Config::LoadFromINI() {
-    CSimpleIniA ini;
-    ini.SetUnicode();
+const Config* Config::GetSingleton() {
+    return Storage().Load();
+}
+
+const Config* Config::Load() {
+    std::lock_guard<std::mutex> lock(g_loadLock);
+
+    auto next = std::make_unique<Config>();
+    next->generation = ++g_generation;
+
+    auto configPath = FindConfigPath();
+    g_loadedWriteTime = CurrentWriteTime();
+    next->ReadINI(configPath.string());
+
+    const auto* previous = Storage().Load();
+    if (previous) {
+        auto keep = [](const char* name, auto& value, auto startup) {
+            if (value != startup) {
+                SKSE::log::info("  {} takes effect after a restart", name);
+                value = startup;
+            }
+        };
+        keep("bPerCastScaling", next->bPerCastScaling, previous->bPerCastScaling);
+        keep("bUseShoutHook", next->bUseShoutHook, previous->bUseShoutHook);
+        keep("iDebugLogMode", next->iDebugLogMode, previous->iDebugLogMode);
+        keep("bCaptureShoutEvents", next->bCaptureShoutEvents, previous->bCaptureShoutEvents);
+
+        ApplyRuntimeSettings(previous, *next);
+    }
+
+    next->BakeCurves();
+    RulesFile::Load(next->iMaxDragonSouls, next->rules, next->actorSouls);
+    const auto* published = Storage().Publish(std::move(next));
+    Storage().Reclaim(RETAINED_CONFIGS);
+    if (previous) {
+        SKSE::log::info("Configuration reloaded (generation {})", published->generation);
+        BatchScaler::GetSingleton()->Schedule();
+    }
+    return published;
+}
 
-    auto mcmUserPath = std::filesystem::path("Data") / "MCM" / "Settings" / "ShoutProgression - MCM.ini";
-    auto mcmDefaultPath = std::filesystem::path("Data") / "MCM" / "Config" / "ShoutProgression - MCM" / "settings.ini";
-    auto legacyPath = std::filesystem::path("Data") / "SKSE" / "Plugins" / "ShoutProgression.ini";
-
-    std::filesystem::path configPath;
-
-    if (std::filesystem::exists(mcmUserPath)) {
-        configPath = mcmUserPath;
-        SKSE::log::info("Loading configuration from MCM user settings: {}", configPath.string());
-    } else if (std::filesystem::exists(mcmDefaultPath)) {
-        configPath = mcmDefaultPath;
-        SKSE::log::info("Loading configuration from MCM defaults: {}", configPath.string());
-    } else if (std::filesystem::exists(legacyPath)) {
-        configPath = legacyPath;
-        SKSE::log::info("Loading configuration from legacy INI: {}", configPath.string());
-    } else {
+void Config::RequestReload() {
+    // Load() looks forms up for the rules file and schedules a batch, both of which race the engine off its thread.
+    // Requests made before the queued reload has run are folded into it.
+    if (g_reloadQueued.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    SKSE::GetTaskInterface()->AddTask([]() {
+        g_reloadQueued.store(false, std::memory_order_release);
+        Load();
+    });
+}
+
+void Config::StartWatching() {
+    auto interval = std::chrono::seconds(GetSingleton()->iReloadPollInterval);
+    if (interval <= std::chrono::seconds::zero()) {
+        SKSE::log::info("Configuration file watching disabled");
+        return;
+    }
+
+    // Detached: the thread only sleeps and stats one file, and the process tears it down on exit. The reload itself
+    // runs on the game thread.
+    std::thread([interval]() {
+        auto observed = CurrentWriteTime();
+        while (true) {
+            std::this_thread::sleep_for(interval);
+
+            // MCM Helper rewrites the file once per changed setting; reload only after it has stopped changing for
+            // a full interval, so a file caught mid-write is never parsed
+            auto current = CurrentWriteTime();
+            if (current != observed) {
+                observed = current;
+                continue;
+            }
+
+            bool changed;
+            {
+                std::lock_guard<std::mutex> lock(g_loadLock);
+                changed = current != g_loadedWriteTime;
+            }
+            if (changed) {
+                RequestReload();
+            }
+        }
+    }).detach();
+
+    SKSE::log::info("Watching configuration file for changes every {}s", interval.count());
+}
+
+void Config::ReadINI(const std::string& configPath) {
+    if (configPath.empty()) {
         SKSE::log::info("No configuration file found, using default values");
         return;
     }
 
-    if (ini.LoadFile(configPath.string().c_str()) < 0) {
-        SKSE::log::warn("Failed to load configuration from {}, using default values", configPath.string());
+    CSimpleIniA ini;
+    ini.SetUnicode();
+
+    SKSE::log::info("Loading configuration from {}", configPath);
+    if (ini.LoadFile(configPath.c_str()) < 0) {
+        SKSE::log::warn("Failed to load configuration from {}, using default values", configPath);
         return;
     }
 
@@ -47,22 +173,108 @@ void Config::LoadFromINI() {
     fCooldownReduction = static_cast<float>(ini.GetDoubleValue("ShoutProgression", "fCooldownReduction", fCooldownReduction));
     iMaxDragonSouls = static_cast<int>(ini.GetLongValue("ShoutProgression", "iMaxDragonSouls", iMaxDragonSouls));
     bCountSpentSouls = ini.GetBoolValue("ShoutProgression", "bCountSpentSouls", bCountSpentSouls);
+    bPerCastScaling = ini.GetBoolValue("ShoutProgression", "bPerCastScaling", bPerCastScaling);
+    bUseShoutHook = ini.GetBoolValue("ShoutProgression", "bUseShoutHook", bUseShoutHook);
 
     fMinDistanceMultiplier = static_cast<float>(ini.GetDoubleValue("ShoutProgression", "fMinDistanceMultiplier", fMinDistanceMultiplier));
     fMinMagnitudeMultiplier = static_cast<float>(ini.GetDoubleValue("ShoutProgression", "fMinMagnitudeMultiplier", fMinMagnitudeMultiplier));
     fMinCooldownMultiplier = static_cast<float>(ini.GetDoubleValue("ShoutProgression", "fMinCooldownMultiplier", fMinCooldownMultiplier));
 
+    iDistanceCurve = static_cast<int>(ini.GetLongValue("ShoutProgression", "iDistanceCurve", iDistanceCurve));
+    iMagnitudeCurve = static_cast<int>(ini.GetLongValue("ShoutProgression", "iMagnitudeCurve", iMagnitudeCurve));
+    iCooldownCurve = static_cast<int>(ini.GetLongValue("ShoutProgression", "iCooldownCurve", iCooldownCurve));
+    fDistanceCurveLimit = static_cast<float>(ini.GetDoubleValue("ShoutProgression", "fDistanceCurveLimit", fDistanceCurveLimit));
+    fMagnitudeCurveLimit = static_cast<float>(ini.GetDoubleValue("ShoutProgression", "fMagnitudeCurveLimit", fMagnitudeCurveLimit));
+    sDistanceCurvePoints = ini.GetValue("ShoutProgression", "sDistanceCurvePoints", sDistanceCurvePoints.c_str());
+    sMagnitudeCurvePoints = ini.GetValue("ShoutProgression", "sMagnitudeCurvePoints", sMagnitudeCurvePoints.c_str());
+    sCooldownCurvePoints = ini.GetValue("ShoutProgression", "sCooldownCurvePoints", sCooldownCurvePoints.c_str());
+
     bEnableDebugLogging = ini.GetBoolValue("General", "bEnableDebugLogging", bEnableDebugLogging);
+    iDebugLogMode = static_cast<int>(ini.GetLongValue("General", "iDebugLogMode", iDebugLogMode));
+    bEnableMetrics = ini.GetBoolValue("General", "bEnableMetrics", bEnableMetrics);
+    iMetricsDumpInterval = static_cast<int>(ini.GetLongValue("General", "iMetricsDumpInterval", iMetricsDumpInterval));
+    iReloadPollInterval = static_cast<int>(ini.GetLongValue("General", "iReloadPollInterval", iReloadPollInterval));
+    bCaptureShoutEvents = ini.GetBoolValue("General", "bCaptureShoutEvents", bCaptureShoutEvents);
+    bUsePlanCache = ini.GetBoolValue("General", "bUsePlanCache", bUsePlanCache);
+    bBatchScaling = ini.GetBoolValue("ShoutProgression", "bBatchScaling", bBatchScaling);
+    bNPCProgression = ini.GetBoolValue("ShoutProgression", "bNPCProgression", bNPCProgression);
+    bFollowerProgression = ini.GetBoolValue("ShoutProgression", "bFollowerProgression", bFollowerProgression);
+    fNPCSoulsPerLevel = static_cast<float>(ini.GetDoubleValue("ShoutProgression", "fNPCSoulsPerLevel", fNPCSoulsPerLevel));
+    iPlanBuildThreads = static_cast<int>(ini.GetLongValue("General", "iPlanBuildThreads", iPlanBuildThreads));
+
+    LogSettings();
+}
 
+void Config::LogSettings() const {
     SKSE::log::info("Configuration loaded:");
     SKSE::log::info("  fDistanceMultiplier: {}", fDistanceMultiplier);
     SKSE::log::info("  fMagnitudeMultiplier: {}", fMagnitudeMultiplier);
     SKSE::log::info("  fCooldownReduction: {}", fCooldownReduction);
     SKSE::log::info("  iMaxDragonSouls: {}", iMaxDragonSouls);
     SKSE::log::info("  bCountSpentSouls: {}", bCountSpentSouls);
+    SKSE::log::info("  bPerCastScaling: {}", bPerCastScaling);
+    SKSE::log::info("  bUseShoutHook: {}", bUseShoutHook);
+    SKSE::log::info("  bBatchScaling: {}", bBatchScaling);
+    SKSE::log::info("  bNPCProgression: {}", bNPCProgression);
+    SKSE::log::info("  bFollowerProgression: {}", bFollowerProgression);
+    SKSE::log::info("  fNPCSoulsPerLevel: {}", fNPCSoulsPerLevel);
     SKSE::log::info("  fMinDistanceMultiplier: {}", fMinDistanceMultiplier);
     SKSE::log::info("  fMinMagnitudeMultiplier: {}", fMinMagnitudeMultiplier);
     SKSE::log::info("  fMinCooldownMultiplier: {}", fMinCooldownMultiplier);
     SKSE::log::info("  bEnableDebugLogging: {}", bEnableDebugLogging);
+    SKSE::log::info("  iDebugLogMode: {}", iDebugLogMode);
+    SKSE::log::info("  bEnableMetrics: {}", bEnableMetrics);
+    SKSE::log::info("  iMetricsDumpInterval: {}", iMetricsDumpInterval);
+    SKSE::log::info("  iReloadPollInterval: {}", iReloadPollInterval);
+    SKSE::log::info("  bCaptureShoutEvents: {}", bCaptureShoutEvents);
+    SKSE::log::info("  bUsePlanCache: {}", bUsePlanCache);
+    SKSE::log::info("  iPlanBuildThreads: {}", iPlanBuildThreads);
+}
+
+void Config::BakeCurves() {
+    auto toType = [](int value) {
+        return static_cast<Curves::Type>(std::clamp(value, 0, static_cast<int>(Curves::Type::kPiecewise)));
+    };
+
+    Curves::Curve distance;
+    distance.type = toType(iDistanceCurve);
+    distance.base = fMinDistanceMultiplier;
+    distance.rate = fDistanceMultiplier;
+    distance.limit = fDistanceCurveLimit;
+    distance.points = Curves::ParsePoints(sDistanceCurvePoints);
+
+    Curves::Curve magnitude;
+    magnitude.type = toType(iMagnitudeCurve);
+    magnitude.base = fMinMagnitudeMultiplier;
+    magnitude.rate = fMagnitudeMultiplier;
+    magnitude.limit = fMagnitudeCurveLimit;
+    magnitude.points = Curves::ParsePoints(sMagnitudeCurvePoints);
+
+    // Cooldown starts at 100% and falls by fCooldownReduction per soul, never below fMinCooldownMultiplier
+    Curves::Curve cooldown;
+    cooldown.type = toType(iCooldownCurve);
+    cooldown.base = 1.0f;
+    cooldown.rate = -fCooldownReduction;
+    cooldown.limit = fMinCooldownMultiplier;
+    cooldown.min = fMinCooldownMultiplier;
+    cooldown.points = Curves::ParsePoints(sCooldownCurvePoints);
+
+    distanceTable.Bake(distance, iMaxDragonSouls);
+    magnitudeTable.Bake(magnitude, iMaxDragonSouls);
+    cooldownTable.Bake(cooldown, iMaxDragonSouls);
+
+    auto describe = [this](const char* name, const Curves::MultiplierTable& table) {
+        if (table.IsTabulated()) {
+            SKSE::log::info("  {} curve: {}, baked into {} entries ({} bytes)", name,
+                            Curves::TypeName(table.GetCurve().type), iMaxDragonSouls + 1, table.GetMemoryFootprint());
+        } else {
+            SKSE::log::info("  {} curve: {}, evaluated directly (iMaxDragonSouls {} exceeds table limit {})", name,
+                            Curves::TypeName(table.GetCurve().type), iMaxDragonSouls,
+                            Curves::MultiplierTable::MAX_TABLE_SIZE - 1);
+        }
+    };
+    describe("Distance", distanceTable);
+    describe("Magnitude", magnitudeTable);
+    describe("Cooldown", cooldownTable);
 }
 
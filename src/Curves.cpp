@@ -0,0 +1,128 @@
+#include "Curves.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace Curves {
+    namespace {
+        float EvaluatePiecewise(const std::vector<std::pair<float, float>>& points, float souls) {
+            if (points.empty()) {
+                return 1.0f;
+            }
+            if (souls <= points.front().first) {
+                return points.front().second;
+            }
+            if (souls >= points.back().first) {
+                return points.back().second;
+            }
+
+            auto upper = std::upper_bound(points.begin(), points.end(), souls,
+                                          [](float value, const std::pair<float, float>& point) {
+                                              return value < point.first;
+                                          });
+            auto lower = upper - 1;
+            float span = upper->first - lower->first;
+            float t = span > 0.0f ? (souls - lower->first) / span : 0.0f;
+            return lower->second + t * (upper->second - lower->second);
+        }
+
+        std::string_view Trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        bool ParseFloat(std::string_view text, float& value) {
+            text = Trim(text);
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return ec == std::errc() && ptr == text.data() + text.size();
+        }
+    }
+
+    float Curve::Evaluate(int souls) const {
+        float s = static_cast<float>(souls);
+        float value = base;
+
+        switch (type) {
+            case Type::kLinear:
+                value = base + rate * s;
+                break;
+            case Type::kLogarithmic:
+                value = base + rate * std::log1p(s);
+                break;
+            case Type::kExponentialDecay: {
+                float span = limit - base;
+                if (span == 0.0f || rate == 0.0f) {
+                    value = base;
+                    break;
+                }
+                float k = std::fabs(rate / span);
+                value = limit - span * std::exp(-k * s);
+                break;
+            }
+            case Type::kPiecewise:
+                value = EvaluatePiecewise(points, s);
+                break;
+        }
+
+        return std::clamp(value, min, max);
+    }
+
+    const char* TypeName(Type type) {
+        switch (type) {
+            case Type::kLinear:
+                return "linear";
+            case Type::kLogarithmic:
+                return "logarithmic";
+            case Type::kExponentialDecay:
+                return "exponential decay";
+            case Type::kPiecewise:
+                return "piecewise";
+        }
+        return "unknown";
+    }
+
+    std::vector<std::pair<float, float>> ParsePoints(std::string_view text) {
+        std::vector<std::pair<float, float>> points;
+
+        while (!text.empty()) {
+            auto comma = text.find(',');
+            auto pair = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+            auto colon = pair.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+
+            float souls;
+            float multiplier;
+            if (ParseFloat(pair.substr(0, colon), souls) && ParseFloat(pair.substr(colon + 1), multiplier)) {
+                points.emplace_back(souls, multiplier);
+            }
+        }
+
+        std::sort(points.begin(), points.end());
+        return points;
+    }
+
+    void MultiplierTable::Bake(const Curve& curve, int maxSouls) {
+        _curve = curve;
+        _maxSouls = std::max(maxSouls, 0);
+        _values.clear();
+
+        if (_maxSouls >= MAX_TABLE_SIZE) {
+            _values.shrink_to_fit();
+            return;
+        }
+
+        _values.resize(static_cast<std::size_t>(_maxSouls) + 1);
+        for (int souls = 0; souls <= _maxSouls; souls++) {
+            _values[static_cast<std::size_t>(souls)] = curve.Evaluate(souls);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include "core/MappedFile.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Core {
+#ifdef _WIN32
+    bool MappedFile::Open(const std::filesystem::path& path) {
+        Close();
+
+        auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        auto* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            return false;
+        }
+
+        _file = file;
+        _mapping = mapping;
+        _data = static_cast<const std::byte*>(view);
+        _size = static_cast<std::size_t>(size.QuadPart);
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (_data) {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping) {
+            CloseHandle(_mapping);
+        }
+        if (_file) {
+            CloseHandle(_file);
+        }
+        _data = nullptr;
+        _size = 0;
+        _mapping = nullptr;
+        _file = nullptr;
+    }
+#else
+    bool MappedFile::Open(const std::filesystem::path& path) {
+        Close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        auto size = static_cast<std::size_t>(info.st_size);
+        void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+
+        _data = static_cast<const std::byte*>(view);
+        _size = size;
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (_data) {
+            ::munmap(const_cast<std::byte*>(_data), _size);
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+#endif
+}
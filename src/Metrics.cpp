@@ -0,0 +1,179 @@
+#include "Metrics.h"
+#include "core/MemoryAccounting.h"
+#include <SKSE/SKSE.h>
+#include <bit>
+
+namespace Metrics {
+    namespace {
+        std::array<Histogram, static_cast<std::size_t>(Probe::kCount)> g_histograms;
+        std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::kCount)> g_counters{};
+        std::atomic<std::int64_t> g_lastPeriodicDump{ 0 };
+
+        const char* ProbeName(Probe probe) {
+            switch (probe) {
+                case Probe::kProcessEvent:
+                    return "ProcessEvent";
+                case Probe::kApplyShoutScaling:
+                    return "ApplyShoutScaling";
+                case Probe::kRestoreNPCShoutValues:
+                    return "RestoreNPCShoutValues";
+                case Probe::kCountUnlockedShoutWords:
+                    return "CountUnlockedShoutWords";
+                case Probe::kBatchCommit:
+                    return "BatchCommit";
+                case Probe::kCount:
+                    break;
+            }
+            return "unknown";
+        }
+
+        const char* CounterName(Counter counter) {
+            switch (counter) {
+                case Counter::kEventsSeen:
+                    return "events seen";
+                case Counter::kEventsFiltered:
+                    return "events filtered";
+                case Counter::kPlayerCasts:
+                    return "player casts";
+                case Counter::kNPCCasts:
+                    return "NPC casts";
+                case Counter::kEffectsWritten:
+                    return "effects written";
+                case Counter::kProjectilesWritten:
+                    return "projectiles written";
+                case Counter::kLockWaits:
+                    return "lock waits";
+                case Counter::kBatchRecordsWritten:
+                    return "batch records written";
+                case Counter::kCount:
+                    break;
+            }
+            return "unknown";
+        }
+
+        // Upper bound of a log2 bucket: bucket i holds values in [2^(i-1), 2^i)
+        std::uint64_t BucketLimit(std::size_t bucket) {
+            return bucket == 0 ? 0 : (bucket >= 63 ? UINT64_MAX : (std::uint64_t{ 1 } << bucket) - 1);
+        }
+
+        std::int64_t NowSeconds() {
+            return std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+    }
+
+    void Histogram::Record(std::uint64_t nanoseconds) {
+        auto bucket = static_cast<std::size_t>(std::bit_width(nanoseconds));
+        _buckets[std::min(bucket, BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _total.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+        auto max = _max.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+        }
+    }
+
+    Histogram::Summary Histogram::Summarize() const {
+        Summary summary{};
+        summary.count = _count.load(std::memory_order_relaxed);
+        summary.max = _max.load(std::memory_order_relaxed);
+        if (summary.count == 0) {
+            return summary;
+        }
+        summary.mean = _total.load(std::memory_order_relaxed) / summary.count;
+
+        auto p50Rank = (summary.count + 1) / 2;
+        auto p99Rank = summary.count - summary.count / 100;
+        std::uint64_t seen = 0;
+        bool p50Found = false;
+        for (std::size_t i = 0; i < BUCKETS; i++) {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (!p50Found && seen >= p50Rank) {
+                summary.p50 = std::min(BucketLimit(i), summary.max);
+                p50Found = true;
+            }
+            if (seen >= p99Rank) {
+                summary.p99 = std::min(BucketLimit(i), summary.max);
+                break;
+            }
+        }
+        return summary;
+    }
+
+    void Histogram::Reset() {
+        for (auto& bucket : _buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        _count.store(0, std::memory_order_relaxed);
+        _total.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+    void SetEnabled(bool enabled) {
+        g_enabled.store(enabled, std::memory_order_relaxed);
+        g_lastPeriodicDump.store(NowSeconds(), std::memory_order_relaxed);
+    }
+
+    void RecordLatency(Probe probe, std::uint64_t nanoseconds) {
+        g_histograms[static_cast<std::size_t>(probe)].Record(nanoseconds);
+    }
+
+    void Add(Counter counter, std::uint64_t amount) {
+        g_counters[static_cast<std::size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    void Dump() {
+        if (!SHOUTPROGRESSION_METRICS) {
+            SKSE::log::info("Metrics are not compiled into this build");
+            return;
+        }
+
+        SKSE::log::info("Shout Progression metrics{}:", IsEnabled() ? "" : " (recording disabled)");
+        for (std::size_t i = 0; i < g_histograms.size(); i++) {
+            auto summary = g_histograms[i].Summarize();
+            SKSE::log::info("  {:<24} n={:<8} p50<={}ns p99<={}ns max={}ns mean={}ns", ProbeName(static_cast<Probe>(i)),
+                            summary.count, summary.p50, summary.p99, summary.max, summary.mean);
+        }
+        for (std::size_t i = 0; i < g_counters.size(); i++) {
+            SKSE::log::info("  {:<24} {}", CounterName(static_cast<Counter>(i)),
+                            g_counters[i].load(std::memory_order_relaxed));
+        }
+        DumpMemory();
+    }
+
+    void DumpMemory() {
+        SKSE::log::info("Shout Progression memory:");
+        for (std::size_t i = 0; i < static_cast<std::size_t>(Core::Subsystem::kCount); i++) {
+            auto usage = Core::MemoryAccounting::GetUsage(static_cast<Core::Subsystem>(i));
+            SKSE::log::info("  {:<24} {} bytes live, {} peak, {} allocations", Core::SUBSYSTEM_NAMES[i], usage.bytes,
+                            usage.peakBytes, usage.allocations);
+        }
+        auto total = Core::MemoryAccounting::GetTotal();
+        SKSE::log::info("  {:<24} {} bytes live, {} allocations", "total", total.bytes, total.allocations);
+    }
+
+    void Reset() {
+        for (auto& histogram : g_histograms) {
+            histogram.Reset();
+        }
+        for (auto& counter : g_counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void MaybeDumpPeriodic(std::uint32_t intervalSeconds) {
+        if (intervalSeconds == 0 || !IsEnabled()) {
+            return;
+        }
+
+        auto now = NowSeconds();
+        auto last = g_lastPeriodicDump.load(std::memory_order_relaxed);
+        if (now - last < static_cast<std::int64_t>(intervalSeconds)) {
+            return;
+        }
+        if (g_lastPeriodicDump.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            Dump();
+        }
+    }
+}
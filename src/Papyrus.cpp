@@ -0,0 +1,40 @@
+#include "Papyrus.h"
+#include "Config.h"
+#include "Metrics.h"
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+using namespace std::literals;
+
+namespace Papyrus {
+    namespace {
+        constexpr std::string_view SCRIPT_NAME = "ShoutProgression"sv;
+
+        void DumpMetrics(RE::StaticFunctionTag*) {
+            Metrics::Dump();
+        }
+
+        void ResetMetrics(RE::StaticFunctionTag*) {
+            Metrics::Reset();
+            SKSE::log::info("Metrics reset");
+        }
+
+        void SetMetricsEnabled(RE::StaticFunctionTag*, bool enabled) {
+            Metrics::SetEnabled(enabled);
+            SKSE::log::info("Metrics recording {}", enabled ? "enabled" : "disabled");
+        }
+
+        // Called on a VM thread; the reload runs on the game thread
+        void ReloadConfig(RE::StaticFunctionTag*) {
+            Config::RequestReload();
+        }
+    }
+
+    bool Register(RE::BSScript::IVirtualMachine* vm) {
+        vm->RegisterFunction("DumpMetrics"sv, SCRIPT_NAME, DumpMetrics);
+        vm->RegisterFunction("ResetMetrics"sv, SCRIPT_NAME, ResetMetrics);
+        vm->RegisterFunction("SetMetricsEnabled"sv, SCRIPT_NAME, SetMetricsEnabled);
+        vm->RegisterFunction("ReloadConfig"sv, SCRIPT_NAME, ReloadConfig);
+        return true;
+    }
+}
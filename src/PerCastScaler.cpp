@@ -0,0 +1,225 @@
+#include "PerCastScaler.h"
+#include "Config.h"
+#include "TraceLog.h"
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+#include <algorithm>
+
+template <class T>
+struct AddTargetHook {
+    static bool thunk(RE::MagicTarget* a_this, RE::MagicTarget::AddTargetData& a_data) {
+        auto* scaler = PerCastScaler::GetSingleton();
+        scaler->ScaleTargetData(a_data);
+        bool added = func(a_this, a_data);
+        if (added) {
+            scaler->ScaleActiveEffect(a_this, a_data);
+        }
+        return added;
+    }
+    static inline REL::Relocation<decltype(thunk)> func;
+
+    static void Install() {
+        // MagicTarget is the fifth base of Actor-derived classes
+        REL::Relocation<std::uintptr_t> vtbl{ T::VTABLE[4] };
+        func = vtbl.write_vfunc(0x1, thunk);
+    }
+};
+
+template <class T>
+struct ProjectileUpdateHook {
+    static void thunk(T* a_this, float a_delta) {
+        PerCastScaler::GetSingleton()->ScaleProjectile(a_this);
+        func(a_this, a_delta);
+    }
+    static inline REL::Relocation<decltype(thunk)> func;
+
+    static void Install() {
+        REL::Relocation<std::uintptr_t> vtbl{ T::VTABLE[0] };
+        func = vtbl.write_vfunc(0xAB, thunk);
+    }
+};
+
+PerCastScaler* PerCastScaler::GetSingleton() {
+    static PerCastScaler singleton;
+    return &singleton;
+}
+
+void PerCastScaler::Install() {
+    if (_installed) {
+        return;
+    }
+
+    AddTargetHook<RE::Character>::Install();
+    AddTargetHook<RE::PlayerCharacter>::Install();
+
+    ProjectileUpdateHook<RE::ConeProjectile>::Install();
+    ProjectileUpdateHook<RE::MissileProjectile>::Install();
+    ProjectileUpdateHook<RE::BeamProjectile>::Install();
+    ProjectileUpdateHook<RE::FlameProjectile>::Install();
+    ProjectileUpdateHook<RE::BarrierProjectile>::Install();
+
+    _installed = true;
+    SKSE::log::info("Per-cast scaling hooks installed");
+}
+
+bool PerCastScaler::IsPlayerShout(const RE::TESObjectREFR* caster, const RE::MagicItem* item) {
+    return caster && caster->IsPlayerRef() && item && item->GetSpellType() == RE::MagicSystem::SpellType::kVoicePower;
+}
+
+void PerCastScaler::OnPlayerShoutFired(RE::PlayerCharacter* player, const ScalingPlan::Multipliers& multipliers) {
+    {
+        auto handle = player->GetHandle();
+        std::lock_guard<std::mutex> lock(_lock);
+        _casts.insert_or_assign(handle.native_handle(), Scaled{ handle, multipliers });
+        if (_casts.size() > PRUNE_SIZE) {
+            Prune(_casts);
+        }
+    }
+
+    // The recovery timer is set by the engine while the shout is released, so scale it on the next task tick rather
+    // than inside the event.
+    auto cooldown = multipliers.cooldown;
+    SKSE::GetTaskInterface()->AddTask([cooldown]() {
+        auto* player = RE::PlayerCharacter::GetSingleton();
+        if (!player) {
+            return;
+        }
+        auto& voiceTimer = player->GetActorRuntimeData().voiceTimer;
+        auto original = voiceTimer;
+        voiceTimer = original * cooldown;
+
+        if (Config::GetSingleton()->bEnableDebugLogging) {
+            TraceLog::GetSingleton()->Write(Trace::Event::kVoiceTimer, 0, original, voiceTimer);
+        }
+    });
+}
+
+void PerCastScaler::ScaleTargetData(RE::MagicTarget::AddTargetData& data) {
+    if (!IsPlayerShout(data.caster, data.magicItem) || !data.effect || !data.effect->baseEffect) {
+        return;
+    }
+
+    auto scaling = Core::GetArchetypeScaling(GameForms::GetArchetype(data.effect->baseEffect));
+    if ((scaling & Core::kScaleArea) && data.effect->effectItem.area != 0 &&
+        !_areaLogged.exchange(true, std::memory_order_relaxed)) {
+        SKSE::log::info("Effect areas are not scaled with bPerCastScaling (first seen on {:08X})",
+                        data.effect->baseEffect->GetFormID());
+    }
+    if (!(scaling & (Core::kScaleMagnitude | Core::kScaleMagnitudeInverse))) {
+        return;
+    }
+
+    ScalingPlan::Multipliers multipliers;
+    if (!FindCast(data.caster->GetHandle(), multipliers)) {
+        return;
+    }
+    auto original = data.magnitude;
+
+    if (scaling & Core::kScaleMagnitudeInverse) {
+        data.magnitude = std::max(original / multipliers.magnitude, Core::MIN_TIME_SCALE);
+    } else {
+        data.magnitude = original * multipliers.magnitude;
+    }
+
+    if (Config::GetSingleton()->bEnableDebugLogging) {
+        TraceLog::GetSingleton()->Write(Trace::Event::kTargetMagnitude, data.effect->baseEffect->GetFormID(), original,
+                                        data.magnitude);
+    }
+}
+
+void PerCastScaler::ScaleActiveEffect(RE::MagicTarget* target, const RE::MagicTarget::AddTargetData& data) {
+    if (!IsPlayerShout(data.caster, data.magicItem) || !data.effect || !data.effect->baseEffect ||
+        data.effect->effectItem.duration == 0) {
+        return;
+    }
+    auto scaling = Core::GetArchetypeScaling(GameForms::GetArchetype(data.effect->baseEffect));
+    if (!(scaling & Core::kScaleDuration)) {
+        return;
+    }
+
+    auto caster = data.caster->GetHandle();
+    ScalingPlan::Multipliers multipliers;
+    auto* effects = target->GetActiveEffectList();
+    if (!effects || !FindCast(caster, multipliers)) {
+        return;
+    }
+
+    // The effect AddTarget just created or refreshed: this caster's, for this effect, not yet ticked
+    auto added = std::find_if(effects->begin(), effects->end(), [&](const RE::ActiveEffect* effect) {
+        return effect && effect->spell == data.magicItem && effect->effect == data.effect &&
+               effect->elapsedSeconds == 0.0f && effect->caster.native_handle() == caster.native_handle();
+    });
+    if (added == effects->end()) {
+        return;
+    }
+
+    auto* effect = *added;
+    auto original = effect->duration;
+    effect->duration = original * multipliers.magnitude;
+
+    if (Config::GetSingleton()->bEnableDebugLogging) {
+        TraceLog::GetSingleton()->Write(Trace::Event::kTargetDuration, data.effect->baseEffect->GetFormID(), original,
+                                        effect->duration);
+    }
+}
+
+bool PerCastScaler::FindCast(RE::ObjectRefHandle shooter, ScalingPlan::Multipliers& multipliers) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto cast = _casts.find(shooter.native_handle());
+    if (cast == _casts.end()) {
+        return false;
+    }
+    multipliers = cast->second.multipliers;
+    return true;
+}
+
+bool PerCastScaler::MarkScaled(RE::ObjectRefHandle projectile, RE::ObjectRefHandle shooter,
+                               ScalingPlan::Multipliers& multipliers) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_projectiles.contains(projectile.native_handle())) {
+        return false;
+    }
+    auto cast = _casts.find(shooter.native_handle());
+    if (cast == _casts.end()) {
+        return false;
+    }
+    multipliers = cast->second.multipliers;
+
+    if (_projectiles.size() >= PRUNE_SIZE) {
+        Prune(_projectiles);
+    }
+    _projectiles.emplace(projectile.native_handle(), Scaled{ projectile, multipliers });
+    return true;
+}
+
+void PerCastScaler::Prune(std::unordered_map<std::uint32_t, Scaled>& scaled) {
+    std::erase_if(scaled, [](const auto& entry) { return !entry.second.handle.get(); });
+}
+
+void PerCastScaler::ScaleProjectile(RE::Projectile* projectile) {
+    // Runs on every update of every projectile in the game: the spell type is a plain read, while resolving the
+    // shooter's handle takes a lock and a reference, so it is only done for voice powers
+    auto& runtimeData = projectile->GetProjectileRuntimeData();
+    auto* spell = runtimeData.spell;
+    if (!spell || spell->GetSpellType() != RE::MagicSystem::SpellType::kVoicePower) {
+        return;
+    }
+    auto shooter = runtimeData.shooter.get();
+    if (!IsPlayerShout(shooter.get(), spell)) {
+        return;
+    }
+
+    // The multipliers of the cast that launched it, kept for the projectile's lifetime
+    ScalingPlan::Multipliers multipliers;
+    if (!MarkScaled(projectile->GetHandle(), runtimeData.shooter, multipliers)) {
+        return;
+    }
+
+    runtimeData.linearVelocity *= multipliers.distance;
+    runtimeData.range *= multipliers.distance;
+
+    if (Config::GetSingleton()->bEnableDebugLogging) {
+        TraceLog::GetSingleton()->Write(Trace::Event::kProjectileScaled, projectile->GetFormID(),
+                                        multipliers.distance);
+    }
+}
@@ -0,0 +1,655 @@
+#include "core/PluginReader.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#if SHOUTPROGRESSION_HAS_ZLIB
+    #include <zlib.h>
+#endif
+
+namespace Esp {
+    namespace {
+        constexpr std::size_t HEADER_SIZE = 24;  // records and groups alike
+
+        constexpr std::uint32_t FLAG_MASTER = 0x00000001;
+        constexpr std::uint32_t FLAG_LIGHT = 0x00000200;
+        constexpr std::uint32_t FLAG_COMPRESSED = 0x00040000;
+
+        constexpr std::uint32_t MAX_FULL_PLUGINS = 0xFE;
+        constexpr std::uint32_t MAX_LIGHT_PLUGINS = 0x1000;
+
+        constexpr std::uint32_t Tag(const char (&name)[5]) {
+            return static_cast<std::uint32_t>(name[0]) | static_cast<std::uint32_t>(name[1]) << 8 |
+                   static_cast<std::uint32_t>(name[2]) << 16 | static_cast<std::uint32_t>(name[3]) << 24;
+        }
+
+        // Record types read, in decode order: each one only references the ones before it
+        enum Type : std::size_t { kPROJ, kMGEF, kSPEL, kSHOU, kTypeCount };
+        constexpr std::array<std::uint32_t, kTypeCount> TYPE_TAGS = { Tag("PROJ"), Tag("MGEF"), Tag("SPEL"),
+                                                                      Tag("SHOU") };
+
+        template <class T>
+        T ReadAt(const std::byte* data) {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return value;
+        }
+
+        // The first 16 bytes of a record header. A group header shares the type and size; its label is at offset 8.
+        struct Header {
+            std::uint32_t type;
+            std::uint32_t size;  // record: data size; group: size including the header
+            std::uint32_t flags;
+            std::uint32_t formID;
+        };
+
+        Header ReadHeader(const std::byte* data) {
+            return { ReadAt<std::uint32_t>(data), ReadAt<std::uint32_t>(data + 4), ReadAt<std::uint32_t>(data + 8),
+                     ReadAt<std::uint32_t>(data + 12) };
+        }
+
+        // Calls visit(tag, data, size) for every subrecord of a record, following XXXX size overrides. Returns false
+        // when a subrecord runs past the record.
+        template <class F>
+        bool ForEachField(const std::byte* data, std::size_t size, F&& visit) {
+            std::size_t offset = 0;
+            std::uint32_t nextSize = 0;
+            while (offset + 6 <= size) {
+                auto tag = ReadAt<std::uint32_t>(data + offset);
+                std::uint32_t length = ReadAt<std::uint16_t>(data + offset + 4);
+                offset += 6;
+                if (nextSize != 0) {
+                    length = nextSize;
+                    nextSize = 0;
+                }
+                if (offset + length > size) {
+                    return false;
+                }
+                if (tag == Tag("XXXX") && length == 4) {
+                    nextSize = ReadAt<std::uint32_t>(data + offset);
+                } else {
+                    visit(tag, data + offset, length);
+                }
+                offset += length;
+            }
+            return offset == size;
+        }
+
+        std::string_view ZString(const std::byte* data, std::size_t size) {
+            std::string_view text(reinterpret_cast<const char*>(data), size);
+            return text.substr(0, text.find('\0'));
+        }
+
+        std::string Lower(std::string_view text) {
+            std::string lower(text);
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return lower;
+        }
+
+        std::string Hex(std::uint32_t formID) {
+            char text[9];
+            std::snprintf(text, sizeof(text), "%08X", formID);
+            return text;
+        }
+
+        bool HasExtension(std::string_view name, std::string_view extension) {
+            return name.size() >= extension.size() && Lower(name.substr(name.size() - extension.size())) == extension;
+        }
+    }
+
+    struct LoadOrder::File {
+        // Where a plugin's forms land at runtime: full plugins own the top byte, light plugins 12 bits under FE
+        struct Slot {
+            std::uint32_t base = 0;
+            bool light = false;
+
+            std::uint32_t Map(std::uint32_t raw) const {
+                return light ? base | (raw & 0xFFF) : base | (raw & 0xFFFFFF);
+            }
+        };
+
+        std::string name;
+        Core::MappedFile mapping;
+        std::uint32_t flags = 0;
+        std::size_t firstGroup = 0;  // offset of the first top-level group, after the TES4 record
+        std::vector<std::string> masterNames;
+        std::vector<Slot> masters;  // by master index
+        Slot self;
+
+        bool IsMaster() const {
+            return (flags & FLAG_MASTER) || HasExtension(name, ".esm") || HasExtension(name, ".esl");
+        }
+        bool IsLight() const { return (flags & FLAG_LIGHT) || HasExtension(name, ".esl"); }
+
+        // A raw FormID's top byte indexes the file's masters; anything past them is the file's own form
+        std::uint32_t Map(std::uint32_t raw) const {
+            if (raw == 0) {
+                return 0;
+            }
+            auto index = raw >> 24;
+            return index < masters.size() ? masters[index].Map(raw) : self.Map(raw);
+        }
+    };
+
+    // The winning version of a record, kept until it is decoded
+    struct LoadOrder::Raw {
+        const File* file;
+        const std::byte* data;  // record header
+        std::uint32_t order;    // creation order: the first plugin to define the FormID decides
+    };
+
+    struct LoadOrder::Lookup {
+        std::array<std::unordered_map<std::uint32_t, Raw>, kTypeCount> records;
+        std::array<std::uint32_t, kTypeCount> created{};
+
+        std::unordered_map<std::uint32_t, BGSProjectile*> projectiles;
+        std::unordered_map<std::uint32_t, EffectSetting*> effectSettings;
+        std::unordered_map<std::uint32_t, SpellItem*> spells;
+        std::unordered_map<std::uint32_t, TESShout*> shouts;
+    };
+
+    LoadOrder::LoadOrder() = default;
+
+    LoadOrder::~LoadOrder() {
+        if (Active() == this) {
+            Active() = nullptr;
+        }
+    }
+
+    std::vector<std::string_view> LoadOrder::GetCanonicalPlugins() const {
+        std::vector<Core::IndexedPlugin> plugins;
+        plugins.reserve(_files.size());
+        for (const auto& file : _files) {
+            auto index = file->self.light ? (file->self.base >> 12) & 0xFFF : file->self.base >> 24;
+            plugins.push_back({ file->name, file->self.light, index });
+        }
+        return Core::CanonicalLoadOrder(std::move(plugins));
+    }
+
+    void LoadOrder::Clear() {
+        if (Active() == this) {
+            Active() = nullptr;
+        }
+        shouts.clear();
+        _plugins.clear();
+        _files.clear();
+        _inflated.clear();
+        _projectiles.clear();
+        _effectSettings.clear();
+        _effects.clear();
+        _spells.clear();
+        _words.clear();
+        _shouts.clear();
+        _lookup.reset();
+        _stats = {};
+    }
+
+    bool LoadOrder::Read(const std::filesystem::path& dataDirectory, const std::vector<std::string>& plugins,
+                         std::string& error) {
+        Clear();
+        _lookup = std::make_unique<Lookup>();
+
+        auto fail = [this, &error](const std::string& name, const std::string& reason) {
+            error = name + ": " + reason;
+            Clear();
+            return false;
+        };
+
+        // Headers first: the master flag decides the load order, and the load order decides every FormID
+        for (const auto& name : plugins) {
+            auto file = std::make_unique<File>();
+            file->name = name;
+            if (!file->mapping.Open(dataDirectory / name)) {
+                return fail(name, "cannot be opened");
+            }
+            const auto* data = file->mapping.Data();
+            auto size = file->mapping.Size();
+            _stats.bytesMapped += size;
+
+            if (size < HEADER_SIZE) {
+                return fail(name, "truncated header");
+            }
+            auto header = ReadHeader(data);
+            if (header.type != Tag("TES4") || HEADER_SIZE + header.size > size) {
+                return fail(name, "not a plugin file");
+            }
+            file->flags = header.flags;
+            file->firstGroup = HEADER_SIZE + header.size;
+            bool valid = ForEachField(data + HEADER_SIZE, header.size,
+                                      [&file](std::uint32_t tag, const std::byte* field, std::size_t length) {
+                                          if (tag == Tag("MAST")) {
+                                              file->masterNames.emplace_back(ZString(field, length));
+                                          }
+                                      });
+            if (!valid) {
+                return fail(name, "malformed header record");
+            }
+            _files.push_back(std::move(file));
+        }
+
+        std::stable_partition(_files.begin(), _files.end(), [](const auto& file) { return file->IsMaster(); });
+
+        std::unordered_map<std::string, const File*> byName;
+        std::uint32_t fullCount = 0;
+        std::uint32_t lightCount = 0;
+        for (auto& file : _files) {
+            if (file->IsLight()) {
+                if (lightCount == MAX_LIGHT_PLUGINS) {
+                    return fail(file->name, "more than 4096 light plugins");
+                }
+                file->self = { 0xFE000000u | (lightCount++ << 12), true };
+            } else {
+                if (fullCount == MAX_FULL_PLUGINS) {
+                    return fail(file->name, "more than 254 plugins");
+                }
+                file->self = { fullCount++ << 24, false };
+            }
+
+            for (const auto& master : file->masterNames) {
+                auto it = byName.find(Lower(master));
+                if (it == byName.end()) {
+                    return fail(file->name, "master " + master + " is not loaded before it");
+                }
+                file->masters.push_back(it->second->self);
+            }
+            byName.emplace(Lower(file->name), file.get());
+            _plugins.push_back(file->name);
+        }
+
+        for (std::size_t i = 0; i < _files.size(); i++) {
+            if (!Index(i, error)) {
+                return fail(_files[i]->name, error);
+            }
+        }
+        if (!Decode(error)) {
+            Clear();
+            return false;
+        }
+
+        Active() = this;
+        return true;
+    }
+
+    // Walks the top-level groups of one plugin and records where the latest version of each wanted record lives
+    bool LoadOrder::Index(std::size_t fileIndex, std::string& error) {
+        const auto& file = *_files[fileIndex];
+        const auto* data = file.mapping.Data();
+        const auto size = file.mapping.Size();
+
+        for (auto offset = file.firstGroup; offset < size;) {
+            if (offset + HEADER_SIZE > size) {
+                error = "truncated group header";
+                return false;
+            }
+            auto group = ReadHeader(data + offset);
+            if (group.type != Tag("GRUP") || group.size < HEADER_SIZE || offset + group.size > size) {
+                error = "malformed top-level group";
+                return false;
+            }
+
+            auto label = ReadAt<std::uint32_t>(data + offset + 8);
+            auto type =
+                static_cast<std::size_t>(std::find(TYPE_TAGS.begin(), TYPE_TAGS.end(), label) - TYPE_TAGS.begin());
+            if (type == kTypeCount) {
+                _stats.groupsSkipped++;
+                offset += group.size;
+                continue;
+            }
+            _stats.bytesWalked += group.size;
+
+            auto& records = _lookup->records[type];
+            const auto end = offset + group.size;
+            for (auto position = offset + HEADER_SIZE; position < end;) {
+                if (position + HEADER_SIZE > end) {
+                    error = "truncated record header";
+                    return false;
+                }
+                auto record = ReadHeader(data + position);
+                if (record.type == Tag("GRUP")) {
+                    // Not expected in these groups; skipped the same way
+                    if (record.size < HEADER_SIZE || position + record.size > end) {
+                        error = "malformed nested group";
+                        return false;
+                    }
+                    position += record.size;
+                    continue;
+                }
+                if (position + HEADER_SIZE + record.size > end) {
+                    error = "record runs past its group";
+                    return false;
+                }
+
+                _stats.records++;
+                auto formID = file.Map(record.formID);
+                auto [it, inserted] = records.try_emplace(formID, Raw{ &file, data + position, 0 });
+                if (inserted) {
+                    it->second.order = _lookup->created[type]++;
+                } else {
+                    it->second.file = &file;
+                    it->second.data = data + position;
+                    _stats.overrides++;
+                }
+                position += HEADER_SIZE + record.size;
+            }
+            offset = end;
+        }
+        return true;
+    }
+
+    bool LoadOrder::Decode(std::string& error) {
+        auto& lookup = *_lookup;
+
+        // The record's fields, inflated when the record is compressed
+        auto fields = [this, &error](const Raw& raw, const std::byte*& data, std::size_t& size) {
+            auto header = ReadHeader(raw.data);
+            data = raw.data + HEADER_SIZE;
+            size = header.size;
+            if (!(header.flags & FLAG_COMPRESSED)) {
+                return true;
+            }
+            _stats.compressed++;
+#if SHOUTPROGRESSION_HAS_ZLIB
+            if (size < 4) {
+                error = raw.file->name + ": truncated compressed record " + Hex(raw.file->Map(header.formID));
+                return false;
+            }
+            auto& buffer = _inflated.emplace_back(ReadAt<std::uint32_t>(data));
+            auto length = static_cast<uLongf>(buffer.size());
+            auto result = uncompress(reinterpret_cast<Bytef*>(buffer.data()), &length,
+                                     reinterpret_cast<const Bytef*>(data + 4), static_cast<uLong>(size - 4));
+            if (result != Z_OK || length != buffer.size()) {
+                error = raw.file->name + ": cannot inflate record " + Hex(raw.file->Map(header.formID));
+                return false;
+            }
+            data = buffer.data();
+            size = buffer.size();
+            return true;
+#else
+            error = raw.file->name + ": record " + Hex(raw.file->Map(header.formID)) +
+                    " is compressed, rebuild with zlib to read it";
+            return false;
+#endif
+        };
+
+        // Winning records of a type in creation order
+        auto ordered = [&lookup](Type type) {
+            std::vector<std::pair<std::uint32_t, const Raw*>> list;
+            list.reserve(lookup.records[type].size());
+            for (const auto& [formID, raw] : lookup.records[type]) {
+                list.emplace_back(formID, &raw);
+            }
+            std::sort(list.begin(), list.end(),
+                      [](const auto& a, const auto& b) { return a.second->order < b.second->order; });
+            return list;
+        };
+
+        auto find = [this](const auto& map, std::uint32_t formID) {
+            if (formID == 0) {
+                return static_cast<typename std::decay_t<decltype(map)>::mapped_type>(nullptr);
+            }
+            auto it = map.find(formID);
+            if (it == map.end()) {
+                _stats.unresolved++;
+                return static_cast<typename std::decay_t<decltype(map)>::mapped_type>(nullptr);
+            }
+            return it->second;
+        };
+
+        const std::byte* data = nullptr;
+        std::size_t size = 0;
+
+        for (const auto& [formID, raw] : ordered(kPROJ)) {
+            if (!fields(*raw, data, size)) {
+                return false;
+            }
+            auto& projectile = _projectiles.emplace_back(BGSProjectile{ { 0.0f, 0.0f }, formID, {} });
+            ForEachField(data, size, [&](std::uint32_t tag, const std::byte* field, std::size_t length) {
+                if (tag == Tag("EDID")) {
+                    projectile.editorID = ZString(field, length);
+                } else if (tag == Tag("DATA") && length >= 16) {
+                    projectile.data.speed = ReadAt<float>(field + 8);
+                    projectile.data.range = ReadAt<float>(field + 12);
+                }
+            });
+            lookup.projectiles.emplace(formID, &projectile);
+        }
+
+        for (const auto& [formID, raw] : ordered(kMGEF)) {
+            if (!fields(*raw, data, size)) {
+                return false;
+            }
+            auto& effect = _effectSettings.emplace_back(EffectSetting{ { nullptr }, 0, formID, {} });
+            ForEachField(data, size, [&](std::uint32_t tag, const std::byte* field, std::size_t length) {
+                if (tag == Tag("EDID")) {
+                    effect.editorID = ZString(field, length);
+                } else if (tag == Tag("DATA") && length >= 76) {
+                    effect.archetype = ReadAt<std::uint32_t>(field + 64);
+                    effect.data.projectileBase =
+                        find(lookup.projectiles, raw->file->Map(ReadAt<std::uint32_t>(field + 72)));
+                }
+            });
+            lookup.effectSettings.emplace(formID, &effect);
+        }
+
+        for (const auto& [formID, raw] : ordered(kSPEL)) {
+            if (!fields(*raw, data, size)) {
+                return false;
+            }
+            auto& spell = _spells.emplace_back(SpellItem{ {}, formID, {} });
+            ForEachField(data, size, [&](std::uint32_t tag, const std::byte* field, std::size_t length) {
+                if (tag == Tag("EDID")) {
+                    spell.editorID = ZString(field, length);
+                } else if (tag == Tag("EFID") && length >= 4) {
+                    auto* base = find(lookup.effectSettings, raw->file->Map(ReadAt<std::uint32_t>(field)));
+                    spell.effects.push_back(&_effects.emplace_back(Effect{ { 0.0f, 0, 0 }, base }));
+                } else if (tag == Tag("EFIT") && length >= 12 && !spell.effects.empty()) {
+                    spell.effects.back()->effectItem = { ReadAt<float>(field), ReadAt<std::uint32_t>(field + 4),
+                                                         ReadAt<std::uint32_t>(field + 8) };
+                }
+            });
+            lookup.spells.emplace(formID, &spell);
+        }
+
+        for (const auto& [formID, raw] : ordered(kSHOU)) {
+            if (!fields(*raw, data, size)) {
+                return false;
+            }
+            auto& shout = _shouts.emplace_back();
+            shout.formID = formID;
+            std::size_t variation = 0;
+            ForEachField(data, size, [&](std::uint32_t tag, const std::byte* field, std::size_t length) {
+                if (tag == Tag("EDID")) {
+                    shout.editorID = ZString(field, length);
+                } else if (tag == Tag("SNAM") && length >= 12 && variation < std::size(shout.variations)) {
+                    auto wordID = raw->file->Map(ReadAt<std::uint32_t>(field));
+                    auto* word = wordID ? &_words.emplace_back(TESWordOfPower{ wordID }) : nullptr;
+                    auto* spell = find(lookup.spells, raw->file->Map(ReadAt<std::uint32_t>(field + 4)));
+                    shout.variations[variation++] = { word, spell, ReadAt<float>(field + 8) };
+                }
+            });
+            lookup.shouts.emplace(formID, &shout);
+            shouts.push_back(&shout);
+        }
+
+        // Only the decoded forms are needed from here on
+        for (auto& records : lookup.records) {
+            records = {};
+        }
+        return true;
+    }
+
+    std::vector<SharedProjectile> LoadOrder::FindSharedProjectiles() const {
+        // Projectiles the plan writes, with the shouts that write them, as Core::Plan compiles them
+        std::unordered_map<const BGSProjectile*, std::size_t> index;
+        std::vector<SharedProjectile> shared;
+        std::unordered_set<const SpellItem*> shoutSpells;
+
+        for (const auto* shout : shouts) {
+            for (const auto& variation : shout->variations) {
+                if (!variation.spell) {
+                    continue;
+                }
+                shoutSpells.insert(variation.spell);
+                for (const auto* effect : variation.spell->effects) {
+                    const auto* projectile = effect->baseEffect ? effect->baseEffect->data.projectileBase : nullptr;
+                    if (!projectile) {
+                        continue;
+                    }
+                    auto [it, inserted] = index.try_emplace(projectile, shared.size());
+                    if (inserted) {
+                        shared.push_back({ projectile, {}, {} });
+                    }
+                    auto& users = shared[it->second].shouts;
+                    if (users.empty() || users.back() != shout) {
+                        users.push_back(shout);
+                    }
+                }
+            }
+        }
+
+        for (const auto& spell : _spells) {
+            if (shoutSpells.contains(&spell)) {
+                continue;
+            }
+            for (const auto* effect : spell.effects) {
+                const auto* projectile = effect->baseEffect ? effect->baseEffect->data.projectileBase : nullptr;
+                auto it = projectile ? index.find(projectile) : index.end();
+                if (it != index.end()) {
+                    auto& spells = shared[it->second].spells;
+                    if (spells.empty() || spells.back() != &spell) {
+                        spells.push_back(&spell);
+                    }
+                }
+            }
+        }
+
+        std::erase_if(shared, [](const SharedProjectile& entry) { return entry.spells.empty(); });
+        std::sort(shared.begin(), shared.end(), [](const SharedProjectile& a, const SharedProjectile& b) {
+            return a.spells.size() != b.spells.size() ? a.spells.size() > b.spells.size()
+                                                      : a.projectile->formID < b.projectile->formID;
+        });
+        return shared;
+    }
+
+    std::vector<SharedSpell> LoadOrder::FindSharedSpells() const {
+        std::unordered_map<const SpellItem*, std::vector<const TESShout*>> users;
+        for (const auto* shout : shouts) {
+            for (const auto& variation : shout->variations) {
+                if (!variation.spell) {
+                    continue;
+                }
+                auto& list = users[variation.spell];
+                if (list.empty() || list.back() != shout) {
+                    list.push_back(shout);
+                }
+            }
+        }
+
+        std::vector<SharedSpell> shared;
+        for (auto& [spell, list] : users) {
+            if (list.size() > 1) {
+                shared.push_back({ spell, std::move(list) });
+            }
+        }
+        std::sort(shared.begin(), shared.end(),
+                  [](const SharedSpell& a, const SharedSpell& b) { return a.spell->formID < b.spell->formID; });
+        return shared;
+    }
+
+    Forms::Shout* Forms::LookupShout(std::uint32_t formID) {
+        auto* loadOrder = LoadOrder::Active();
+        if (!loadOrder) {
+            return nullptr;
+        }
+        auto it = loadOrder->_lookup->shouts.find(formID);
+        return it != loadOrder->_lookup->shouts.end() ? it->second : nullptr;
+    }
+
+    void* Forms::Resolve(const Core::RecordKey& key) {
+        auto* loadOrder = LoadOrder::Active();
+        if (!loadOrder) {
+            return nullptr;
+        }
+        const auto& lookup = *loadOrder->_lookup;
+        switch (key.field) {
+            case Core::Field::kRecoveryTime: {
+                auto it = lookup.shouts.find(key.owner);
+                return it != lookup.shouts.end() && key.index < std::size(it->second->variations)
+                           ? &it->second->variations[key.index].recoveryTime
+                           : nullptr;
+            }
+            case Core::Field::kMagnitude:
+            case Core::Field::kDuration:
+            case Core::Field::kArea: {
+                auto it = lookup.spells.find(key.owner);
+                if (it == lookup.spells.end() || key.index >= it->second->effects.size()) {
+                    return nullptr;
+                }
+                auto& item = it->second->effects[key.index]->effectItem;
+                return key.field == Core::Field::kMagnitude ? static_cast<void*>(&item.magnitude)
+                       : key.field == Core::Field::kDuration ? static_cast<void*>(&item.duration)
+                                                             : static_cast<void*>(&item.area);
+            }
+            case Core::Field::kProjectileSpeed:
+            case Core::Field::kProjectileRange: {
+                auto it = lookup.projectiles.find(key.owner);
+                if (it == lookup.projectiles.end()) {
+                    return nullptr;
+                }
+                auto& data = it->second->data;
+                return key.field == Core::Field::kProjectileSpeed ? &data.speed : &data.range;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string> ReadPluginsTxt(const std::filesystem::path& pluginsTxt,
+                                            const std::filesystem::path& dataDirectory) {
+        std::ifstream input(pluginsTxt);
+        if (!input) {
+            return {};
+        }
+
+        std::vector<std::string> plugins;
+        std::unordered_set<std::string> seen;
+        auto add = [&](std::string_view name, bool mustExist) {
+            std::error_code error;
+            if (name.empty() || (mustExist && !std::filesystem::exists(dataDirectory / name, error))) {
+                return;
+            }
+            if (seen.insert(Lower(name)).second) {
+                plugins.emplace_back(name);
+            }
+        };
+        auto trim = [](std::string& line) {
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+                line.pop_back();
+            }
+        };
+
+        for (auto name : { "Skyrim.esm", "Update.esm", "Dawnguard.esm", "HearthFires.esm", "Dragonborn.esm" }) {
+            add(name, true);
+        }
+
+        // Creation Club content sits next to the Data folder
+        std::ifstream ccc(dataDirectory.parent_path() / "Skyrim.ccc");
+        for (std::string line; std::getline(ccc, line);) {
+            trim(line);
+            add(line, true);
+        }
+
+        for (std::string line; std::getline(input, line);) {
+            trim(line);
+            if (line.size() > 1 && line[0] == '*') {
+                add(std::string_view(line).substr(1), false);
+            }
+        }
+        return plugins;
+    }
+}
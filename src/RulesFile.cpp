@@ -0,0 +1,171 @@
+#include "RulesFile.h"
+#include "GameForms.h"
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+#include <SimpleIni.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <list>
+#include <string>
+#include <string_view>
+
+namespace RulesFile {
+    namespace {
+        constexpr auto RULES_PATH = "Data/SKSE/Plugins/ShoutProgression_Rules.ini";
+
+        std::string_view Trim(std::string_view text) {
+            auto first = text.find_first_not_of(" \t");
+            auto last = text.find_last_not_of(" \t");
+            return first == std::string_view::npos ? std::string_view{} : text.substr(first, last - first + 1);
+        }
+
+        // "Skyrim.esm|3CD5E" or "Skyrim.esm|0x0003CD5E" -> load-order FormID, 0 if the plugin or form is missing
+        std::uint32_t ResolveFormKey(RE::TESDataHandler* dataHandler, std::string_view text) {
+            auto separator = text.find('|');
+            if (separator == std::string_view::npos) {
+                return 0;
+            }
+            auto plugin = Trim(text.substr(0, separator));
+            auto id = Trim(text.substr(separator + 1));
+            if (id.starts_with("0x") || id.starts_with("0X")) {
+                id.remove_prefix(2);
+            }
+
+            RE::FormID localID = 0;
+            auto [end, error] = std::from_chars(id.data(), id.data() + id.size(), localID, 16);
+            if (error != std::errc{} || end != id.data() + id.size()) {
+                return 0;
+            }
+            return dataHandler->LookupFormID(localID, plugin);
+        }
+
+        void ReadChannel(CSimpleIniA& ini, const char* section, const char* name, int maxSouls,
+                         Core::RuleChannel& channel, std::vector<Curves::MultiplierTable>& curves) {
+            auto key = [name](const char* prefix, const char* suffix = "") {
+                return std::string(prefix) + name + suffix;
+            };
+
+            channel.scale = ini.GetBoolValue(section, key("bScale").c_str(), channel.scale);
+            channel.min = static_cast<float>(ini.GetDoubleValue(section, key("fMin").c_str(), channel.min));
+            channel.max = static_cast<float>(ini.GetDoubleValue(section, key("fMax").c_str(), channel.max));
+
+            if (const auto* text = ini.GetValue(section, key("s", "CurvePoints").c_str(), nullptr)) {
+                Curves::Curve curve;
+                curve.type = Curves::Type::kPiecewise;
+                curve.points = Curves::ParsePoints(text);
+                if (curve.points.empty()) {
+                    SKSE::log::warn("Shout rule [{}]: no valid points in {}", section, key("s", "CurvePoints"));
+                    return;
+                }
+                channel.curve = static_cast<std::int32_t>(curves.size());
+                curves.emplace_back().Bake(curve, maxSouls);
+            }
+        }
+    }
+
+    void Load(int maxSouls, Core::ShoutRules& compiled, Core::FlatFormMap<std::int32_t>& actorSouls) {
+        compiled = {};
+        actorSouls = {};
+
+        CSimpleIniA ini;
+        ini.SetUnicode();
+        ini.SetMultiKey(true);
+        if (ini.LoadFile(RULES_PATH) < 0) {
+            SKSE::log::info("No shout rules file ({})", RULES_PATH);
+            return;
+        }
+
+        auto* dataHandler = RE::TESDataHandler::GetSingleton();
+        if (!dataHandler) {
+            SKSE::log::error("Failed to get TESDataHandler, shout rules not loaded");
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<Core::ShoutRule> rules;
+        std::vector<Curves::MultiplierTable> curves;
+        std::vector<Core::RuleSelector> selectors;
+        std::vector<std::pair<std::uint32_t, std::int32_t>> actors;
+
+        CSimpleIniA::TNamesDepend sections;
+        ini.GetAllSections(sections);
+        sections.sort(CSimpleIniA::Entry::LoadOrder());
+
+        for (const auto& entry : sections) {
+            const auto* section = entry.pItem;
+            auto index = static_cast<std::uint32_t>(rules.size());
+            auto firstSelector = selectors.size();
+
+            auto forEachValue = [&](const char* key, auto&& resolve) {
+                CSimpleIniA::TNamesDepend values;
+                ini.GetAllValues(section, key, values);
+                for (const auto& value : values) {
+                    if (!resolve(std::string_view(value.pItem))) {
+                        SKSE::log::warn("Shout rule [{}]: {} = {} matches nothing", section, key, value.pItem);
+                    }
+                }
+            };
+
+            // Actor sections pick who progresses rather than how a shout scales
+            if (ini.GetValue(section, "Actor", nullptr)) {
+                auto souls = static_cast<std::int32_t>(ini.GetLongValue(section, "iSouls", ACTOR_SOULS_FROM_LEVEL));
+                souls = souls < 0 ? ACTOR_SOULS_FROM_LEVEL : std::min(souls, maxSouls);
+                forEachValue("Actor", [&](std::string_view text) {
+                    auto formID = ResolveFormKey(dataHandler, text);
+                    if (formID != 0) {
+                        actors.emplace_back(formID, souls);
+                    }
+                    return formID != 0;
+                });
+                continue;
+            }
+
+            forEachValue("Shout", [&](std::string_view text) {
+                auto formID = ResolveFormKey(dataHandler, text);
+                if (formID != 0) {
+                    selectors.push_back({ Core::RuleSelector::Kind::kFormID, formID, index });
+                }
+                return formID != 0;
+            });
+            forEachValue("EditorID", [&](std::string_view text) {
+                auto* shout = RE::TESForm::LookupByEditorID<RE::TESShout>(text);
+                if (shout) {
+                    selectors.push_back({ Core::RuleSelector::Kind::kFormID, shout->GetFormID(), index });
+                }
+                return shout != nullptr;
+            });
+            forEachValue("Archetype", [&](std::string_view text) {
+                auto archetype = Core::ParseArchetype(Trim(text));
+                if (archetype) {
+                    selectors.push_back(
+                        { Core::RuleSelector::Kind::kArchetype, static_cast<std::uint32_t>(*archetype), index });
+                }
+                return archetype.has_value();
+            });
+
+            if (selectors.size() == firstSelector) {
+                SKSE::log::warn("Shout rule [{}] has no usable selector and is ignored", section);
+                continue;
+            }
+
+            auto& rule = rules.emplace_back();
+            ReadChannel(ini, section, "Distance", maxSouls, rule.distance, curves);
+            ReadChannel(ini, section, "Magnitude", maxSouls, rule.magnitude, curves);
+            ReadChannel(ini, section, "Cooldown", maxSouls, rule.cooldown, curves);
+        }
+
+        compiled.Compile<GameForms>(std::move(rules), std::move(curves), selectors,
+                                    dataHandler->GetFormArray<RE::TESShout>());
+        actorSouls.Build(actors);
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        SKSE::log::info("Shout rules: {} rules cover {} shouts, compiled in {} us ({} bytes)",
+                        compiled.GetRuleCount(), compiled.GetShoutCount(), elapsed.count(),
+                        compiled.GetMemoryFootprint());
+        if (actorSouls.Size() > 0) {
+            SKSE::log::info("Shout rules: {} actors progress", actorSouls.Size());
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#include "ScalingPlan.h"
+#include "Config.h"
+#include "Metrics.h"
+#include "TraceLog.h"
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+ScalingPlan* ScalingPlan::GetSingleton() {
+    static ScalingPlan singleton;
+    return &singleton;
+}
+
+namespace {
+    constexpr auto PLAN_CACHE_PATH = "Data/SKSE/Plugins/ShoutProgression.plancache";
+
+    // Active plugins in load order, as the plan cache hashes them
+    // In Core::CanonicalLoadOrder, so the hash matches the one tools/PlanCompile.cpp computes from plugins.txt
+    std::vector<std::string_view> ActivePlugins(RE::TESDataHandler* dataHandler) {
+        std::vector<Core::IndexedPlugin> plugins;
+        for (auto* file : dataHandler->files) {
+            if (!file || file->compileIndex == 0xFF) {
+                continue;
+            }
+            bool light = file->compileIndex == 0xFE;
+            plugins.push_back({ file->GetFilename(), light, light ? file->smallFileCompileIndex : file->compileIndex });
+        }
+        return Core::CanonicalLoadOrder(std::move(plugins));
+    }
+
+    // Compiling a shout is a few microseconds, so small load orders are not worth a thread. Half the cores are left
+    // to the game, which is still loading on its own threads at kDataLoaded.
+    unsigned PickBuildThreads(int configured, std::size_t shoutCount) {
+        if (configured > 0) {
+            return static_cast<unsigned>(configured);
+        }
+        auto cores = std::max(1u, std::thread::hardware_concurrency() / 2);
+        return static_cast<unsigned>(std::clamp<std::size_t>(shoutCount / 256, 1, cores));
+    }
+}
+
+void ScalingPlan::Build() {
+    auto* dataHandler = RE::TESDataHandler::GetSingleton();
+    if (!dataHandler) {
+        SKSE::log::error("Failed to get TESDataHandler, scaling plan not built");
+        return;
+    }
+
+    const auto& shouts = dataHandler->GetFormArray<RE::TESShout>();
+    const auto* config = Config::GetSingleton();
+    auto threads = PickBuildThreads(config->iPlanBuildThreads, shouts.size());
+    std::vector<Core::WorkerStats> workers;
+    auto start = std::chrono::steady_clock::now();
+    const Plan::Snapshot* published = nullptr;
+    const char* source = "compiled";
+
+    if (config->bUsePlanCache) {
+        auto hash = Core::HashLoadOrder("Data", ActivePlugins(dataHandler), shouts.size());
+        std::string error;
+        {
+            // Closed before a stale cache is replaced: Windows cannot rename over a file that is still mapped
+            Core::PlanCacheView cache;
+            if (cache.Open(PLAN_CACHE_PATH, hash, error)) {
+                published = _plan.BuildFromCache(cache, error);
+            }
+        }
+
+        if (published) {
+            source = "loaded from cache";
+        } else {
+            SKSE::log::info("Scaling plan cache not used ({}), compiling", error);
+            Core::PlanCacheData data;
+            published = _plan.Build(shouts, &data, threads, &workers);
+            if (!Core::WritePlanCache(PLAN_CACHE_PATH, hash, data)) {
+                SKSE::log::warn("Failed to write scaling plan cache {}", PLAN_CACHE_PATH);
+            }
+        }
+    } else {
+        published = _plan.Build(shouts, nullptr, threads, &workers);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    SKSE::log::info("Scaling plan {} in {} us: {} shouts, {} records, {} bytes", source, elapsed.count(),
+                    published->entries.size(), published->records.size(), published->GetMemoryFootprint());
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        SKSE::log::info("  worker {}: {} shouts, {} records in {} us", i, workers[i].shouts, workers[i].records,
+                        workers[i].nanoseconds / 1000);
+    }
+
+    // Trace records only carry FormIDs, so name them once here
+    if (config->bEnableDebugLogging) {
+        for (const auto& entry : published->entries) {
+            SKSE::log::info("  {:08X} {} ({} records)", entry.shout->GetFormID(), entry.shout->GetName(), entry.count);
+        }
+    }
+}
+
+void ScalingPlan::OnWrite(RE::TESShout* shout, const Plan::Write& write) {
+    if (write.compiled) {
+        SKSE::log::info("Compiled late shout {:08X} into scaling plan ({} records)", shout->GetFormID(),
+                        write.entry->count);
+    }
+    if (write.written != 0) {
+        SP_METRICS_ADD(kEffectsWritten, write.entry->effects);
+        SP_METRICS_ADD(kProjectilesWritten, write.entry->projectiles);
+    }
+}
+
+std::uint32_t ScalingPlan::Apply(RE::TESShout* shout, const Multipliers& multipliers, std::uint64_t stamp) {
+    auto write = _plan.Apply(shout, multipliers, stamp);
+    OnWrite(shout, write);
+
+    if (write.written != 0 && Config::GetSingleton()->bEnableDebugLogging) {
+        auto* trace = TraceLog::GetSingleton();
+        const auto* begin = write.records;
+        const auto* end = begin + write.written;
+        for (const auto* record = begin; record != end; ++record) {
+            trace->WriteUInt(Trace::Event::kRecordWritten, shout->GetFormID(),
+                             static_cast<std::uint32_t>(record - begin), static_cast<std::uint32_t>(record->transform),
+                             std::bit_cast<std::uint32_t>(record->original),
+                             std::bit_cast<std::uint32_t>(Core::LoadValue(record->target, record->transform)));
+        }
+    }
+
+    return write.written;
+}
+
+std::uint32_t ScalingPlan::Restore(RE::TESShout* shout) {
+    auto write = _plan.Restore(shout);
+    OnWrite(shout, write);
+    return write.written;
+}
+
+std::uint32_t ScalingPlan::Commit(const Batch& batch) {
+    SP_METRICS_SCOPE(kBatchCommit);
+
+    auto written = _plan.Commit(batch);
+    SP_METRICS_ADD(kBatchRecordsWritten, written);
+    return written;
+}
+
+RE::TESShout* ScalingPlan::FindShoutBySpell(const RE::MagicItem* spell) const {
+    return _plan.FindShoutBySpell(spell);
+}
+
+std::size_t ScalingPlan::GetMemoryFootprint() const {
+    return _plan.GetMemoryFootprint();
+}
+
+ScalingPlan::CacheStats ScalingPlan::GetCacheStats() const {
+    return _plan.GetCacheStats();
+}
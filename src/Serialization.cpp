@@ -0,0 +1,144 @@
+#include "Serialization.h"
+#include "Config.h"
+#include "ShoutHandler.h"
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+#include <chrono>
+#include <span>
+
+Serialization* Serialization::GetSingleton() {
+    static Serialization singleton;
+    return &singleton;
+}
+
+void Serialization::Register() {
+    auto* serialization = SKSE::GetSerializationInterface();
+    if (!serialization) {
+        SKSE::log::error("Failed to get serialization interface, scaled shouts are not tracked across saves");
+        return;
+    }
+    serialization->SetUniqueID(UNIQUE_ID);
+    serialization->SetSaveCallback(OnSave);
+    serialization->SetLoadCallback(OnLoad);
+    serialization->SetRevertCallback(OnRevert);
+    SKSE::log::info("Registered co-save callbacks");
+}
+
+void Serialization::OnSave(SKSE::SerializationInterface* serialization) {
+    auto* self = GetSingleton();
+    const auto* config = Config::GetSingleton();
+
+    auto& saved = self->_saved;
+    saved.clear();
+    ScalingPlan::GetSingleton()->ForEachApplied([&saved](RE::TESShout* shout, std::uint64_t stamp) {
+        // An NPC's values are rewritten at its next cast; loading them as the player's would scale the player's shout
+        if (Core::IsNPCStamp(stamp)) {
+            return;
+        }
+        saved.push_back({ shout->GetFormID(), static_cast<std::uint32_t>(Core::StampSouls(stamp)) });
+    });
+
+    AppliedHeader header{ 0, config->generation, static_cast<std::uint32_t>(saved.size()) };
+    if (auto* player = RE::PlayerCharacter::GetSingleton()) {
+        auto souls = ShoutHandler::GetSingleton()->ReadSouls(player, config);
+        header.totalSouls = static_cast<std::uint32_t>(souls.unspent + souls.spent);
+    }
+
+    auto bytes = static_cast<std::uint32_t>(saved.size() * sizeof(AppliedShout));
+    if (!serialization->OpenRecord(APPLIED_RECORD, APPLIED_VERSION) ||
+        !serialization->WriteRecordData(&header, sizeof(header)) ||
+        (bytes != 0 && !serialization->WriteRecordData(saved.data(), bytes))) {
+        SKSE::log::error("Failed to write the applied shout state to the co-save");
+    }
+}
+
+void Serialization::OnLoad(SKSE::SerializationInterface* serialization) {
+    auto* self = GetSingleton();
+
+    std::uint32_t type;
+    std::uint32_t version;
+    std::uint32_t length;
+    while (serialization->GetNextRecordInfo(type, version, length)) {
+        if (type != APPLIED_RECORD) {
+            SKSE::log::warn("Unknown co-save record {:08X}, skipped", type);
+            continue;
+        }
+        if (version != APPLIED_VERSION) {
+            SKSE::log::warn("Applied shout state has version {}, expected {}; skipped", version, APPLIED_VERSION);
+            continue;
+        }
+        if (self->ReadApplied(serialization, length)) {
+            self->_loaded = true;
+            self->Reconcile("co-save");
+        }
+    }
+}
+
+void Serialization::OnRevert(SKSE::SerializationInterface*) {
+    auto* self = GetSingleton();
+    self->_loaded = false;
+    self->_targets.clear();
+}
+
+void Serialization::OnGameLoaded() {
+    if (_loaded) {
+        return;
+    }
+    _targets.clear();
+    Reconcile("no co-save record");
+}
+
+// Fills _targets from the record; shouts whose plugin is gone are dropped
+bool Serialization::ReadApplied(SKSE::SerializationInterface* serialization, std::uint32_t length) {
+    AppliedHeader header;
+    if (length < sizeof(header) || serialization->ReadRecordData(&header, sizeof(header)) != sizeof(header) ||
+        length != sizeof(header) + header.count * sizeof(AppliedShout)) {
+        SKSE::log::error("Applied shout state in the co-save is malformed, ignored");
+        return false;
+    }
+
+    _saved.resize(header.count);
+    auto bytes = static_cast<std::uint32_t>(header.count * sizeof(AppliedShout));
+    if (bytes != 0 && serialization->ReadRecordData(_saved.data(), bytes) != bytes) {
+        SKSE::log::error("Applied shout state in the co-save is truncated, ignored");
+        return false;
+    }
+
+    _targets.clear();
+    for (const auto& saved : _saved) {
+        RE::FormID formID;
+        if (!serialization->ResolveFormID(saved.formID, formID)) {
+            continue;
+        }
+        if (auto* shout = RE::TESForm::LookupByID<RE::TESShout>(formID)) {
+            _targets.push_back({ shout, static_cast<int>(saved.souls) });
+        }
+    }
+
+    if (Config::GetSingleton()->bEnableDebugLogging) {
+        SKSE::log::info("Co-save: {} scaled shouts for {} souls (config generation {} when saved), {} still loaded",
+                        header.count, header.totalSouls, header.generation, _targets.size());
+    }
+    return true;
+}
+
+void Serialization::Reconcile(const char* source) {
+    const auto* config = Config::GetSingleton();
+
+    // Per-cast mode never scales the shared forms, whatever the save recorded
+    if (config->bPerCastScaling) {
+        _targets.clear();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto* handler = ShoutHandler::GetSingleton();
+    auto stats = ScalingPlan::GetSingleton()->Reconcile(
+        std::span<ScalingPlan::Target>(_targets), config->generation,
+        [config, handler](RE::TESShout* shout, int souls) { return handler->GetMultipliers(config, shout, souls); });
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    if (stats.written != 0 || config->bEnableDebugLogging) {
+        SKSE::log::info("Reconciled scaled shouts with the {} in {} us: {} rescaled, {} restored, {} records written",
+                        source, elapsed.count(), stats.applied, stats.restored, stats.written);
+    }
+}
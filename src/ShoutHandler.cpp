@@ -1,323 +1,265 @@
 #include "ShoutHandler.h"
 #include "Config.h"
+#include "Metrics.h"
+#include "PerCastScaler.h"
+#include "RulesFile.h"
+#include "ScalingPlan.h"
+#include "SoulCounter.h"
+#include "TraceLog.h"
 #include <RE/Skyrim.h>
 #include <SKSE/SKSE.h>
-#include <unordered_map>
-#include <mutex>
-
-struct EffectData {
-    std::uint32_t originalDuration;
-    std::uint32_t originalArea;
-    float originalMagnitude;
-};
-static std::unordered_map<RE::Effect*, EffectData> g_originalEffects;
-static std::mutex g_effectsMutex;
-
-struct ProjectileData {
-    float originalSpeed;
-    float originalRange;
-};
-static std::unordered_map<RE::BGSProjectile*, ProjectileData> g_originalProjectiles;
-static std::mutex g_projectilesMutex;
-
-struct ShoutData {
-    float originalRecoveryTimes[3];
-};
-static std::unordered_map<RE::TESShout*, ShoutData> g_originalShouts;
-static std::mutex g_shoutsMutex;
+#include <algorithm>
 
 ShoutHandler* ShoutHandler::GetSingleton() {
     static ShoutHandler singleton;
     return &singleton;
 }
 
-void ShoutHandler::StoreOriginalShoutData(RE::TESShout* shout) {
-    std::lock_guard<std::mutex> lock(g_shoutsMutex);
-    if (g_originalShouts.find(shout) == g_originalShouts.end()) {
-        ShoutData data;
-        for (int i = 0; i < 3; i++) {
-            data.originalRecoveryTimes[i] = shout->variations[i].recoveryTime;
-        }
-        g_originalShouts[shout] = data;
+void ShoutHandler::RestoreNPCShoutValues(RE::TESShout* shout) {
+    SP_METRICS_SCOPE(kRestoreNPCShoutValues);
+
+    auto recordsWritten = ScalingPlan::GetSingleton()->Restore(shout);
+
+    if (Config::GetSingleton()->bEnableDebugLogging) {
+        TraceLog::GetSingleton()->WriteUInt(Trace::Event::kNPCRestore, shout->GetFormID(), recordsWritten);
     }
+
+    LogCacheStats();
 }
 
-void ShoutHandler::RestoreNPCShoutValues(RE::TESShout* shout) {
-    // Restore original shout cooldowns for all variations
-    {
-        std::lock_guard<std::mutex> lock(g_shoutsMutex);
-        auto it = g_originalShouts.find(shout);
-        if (it != g_originalShouts.end()) {
-            for (int i = 0; i < 3; i++) {
-                shout->variations[i].recoveryTime = it->second.originalRecoveryTimes[i];
-            }
-        }
-    }
+void ShoutHandler::ApplyNPCShoutScaling(RE::Actor* actor, RE::TESShout* shout, int souls, const Config* config) {
+    SP_METRICS_SCOPE(kApplyShoutScaling);
 
-    // Restore original effect and projectile values
-    for (int i = 0; i < 3; i++) {
-        auto& variation = shout->variations[i];
-        if (variation.spell) {
-            for (auto* effect : variation.spell->effects) {
-                if (effect && effect->baseEffect) {
-                    {
-                        std::lock_guard<std::mutex> lock(g_effectsMutex);
-                        auto it = g_originalEffects.find(effect);
-                        if (it != g_originalEffects.end()) {
-                            effect->effectItem.duration = it->second.originalDuration;
-                            effect->effectItem.area = it->second.originalArea;
-                            effect->effectItem.magnitude = it->second.originalMagnitude;
-                        }
-                    }
-
-                    auto* projectile = effect->baseEffect->data.projectileBase;
-                    if (projectile) {
-                        std::lock_guard<std::mutex> lock(g_projectilesMutex);
-                        auto it = g_originalProjectiles.find(projectile);
-                        if (it != g_originalProjectiles.end()) {
-                            projectile->data.speed = it->second.originalSpeed;
-                            projectile->data.range = it->second.originalRange;
-                        }
-                    }
-                }
-            }
-        }
+    auto multipliers = GetMultipliers(config, shout, souls);
+    auto stamp = ScalingPlan::MakeNPCStamp(config->generation, souls);
+    auto recordsWritten = ScalingPlan::GetSingleton()->Apply(shout, multipliers, stamp);
+
+    if (config->bEnableDebugLogging) {
+        TraceLog::GetSingleton()->WriteUInt(Trace::Event::kNPCScaled, shout->GetFormID(), actor->GetFormID(),
+                                            static_cast<std::uint32_t>(souls), recordsWritten);
     }
+
+    LogCacheStats();
 }
 
-void ShoutHandler::ApplyShoutScaling(RE::TESShout* shout, int totalSouls) {
-    auto* config = Config::GetSingleton();
+void ShoutHandler::ApplyShoutScaling(RE::TESShout* shout, int totalSouls, const Config* config) {
+    SP_METRICS_SCOPE(kApplyShoutScaling);
 
-    float distanceMultiplier = CalculateDistanceMultiplier(totalSouls);
-    float magnitudeMultiplier = CalculateMagnitudeMultiplier(totalSouls);
-    float cooldownMultiplier = CalculateCooldownMultiplier(totalSouls);
+    auto multipliers = GetMultipliers(config, shout, totalSouls);
 
-    // Apply cooldown scaling to all variations
-    ShoutData originalShoutData;
-    {
-        std::lock_guard<std::mutex> lock(g_shoutsMutex);
-        originalShoutData = g_originalShouts[shout];
+    if (config->bEnableDebugLogging) {
+        TraceLog::GetSingleton()->Write(Trace::Event::kShoutDetected, shout->GetFormID(), multipliers.distance,
+                                        multipliers.magnitude, multipliers.cooldown);
     }
 
-    for (int i = 0; i < 3; i++) {
-        shout->variations[i].recoveryTime = originalShoutData.originalRecoveryTimes[i] * cooldownMultiplier;
-    }
+    auto stamp = ScalingPlan::MakeStamp(config->generation, totalSouls);
+    auto recordsWritten = ScalingPlan::GetSingleton()->Apply(shout, multipliers, stamp);
 
     if (config->bEnableDebugLogging) {
-        SKSE::log::info("Player shout detected: {} (FormID: {:08X})", shout->GetName(), shout->GetFormID());
-        SKSE::log::info("  Distance Multiplier: {}", distanceMultiplier);
-        SKSE::log::info("  Magnitude Multiplier: {}", magnitudeMultiplier);
-        SKSE::log::info("  Cooldown Multiplier: {}", cooldownMultiplier);
-        for (int i = 0; i < 3; i++) {
-            SKSE::log::info("  Variation #{} Recovery Time: {} -> {}",
-                i + 1, originalShoutData.originalRecoveryTimes[i], shout->variations[i].recoveryTime);
-        }
+        TraceLog::GetSingleton()->WriteUInt(Trace::Event::kRecordsTotal, shout->GetFormID(), recordsWritten);
     }
 
-    int effectsModified = 0;
+    LogCacheStats();
+}
 
-    for (int i = 0; i < 3; i++) {
-        auto& variation = shout->variations[i];
-        if (variation.spell) {
-            if (config->bEnableDebugLogging) {
-                SKSE::log::info("  Variation #{} - Spell: {} (FormID: {:08X}), Effect count: {}",
-                    i + 1, variation.spell->GetName(), variation.spell->GetFormID(), variation.spell->effects.size());
-            }
+void ShoutHandler::LogCacheStats() {
+    constexpr std::uint64_t LOG_INTERVAL = 256;
 
-            for (auto* effect : variation.spell->effects) {
-                if (effect && effect->baseEffect) {
-                    if (config->bEnableDebugLogging) {
-                        SKSE::log::info("    Effect: {} (FormID: {:08X}), Archetype: {:08X}",
-                            effect->baseEffect->GetName(),
-                            effect->baseEffect->GetFormID(),
-                            static_cast<std::uint32_t>(effect->baseEffect->GetArchetype()));
-                    }
-
-                    // Store original effect values
-                    {
-                        std::lock_guard<std::mutex> lock(g_effectsMutex);
-                        if (g_originalEffects.find(effect) == g_originalEffects.end()) {
-                            g_originalEffects[effect] = {
-                                effect->effectItem.duration,
-                                effect->effectItem.area,
-                                effect->effectItem.magnitude
-                            };
-                        }
-                    }
-
-                    EffectData original;
-                    {
-                        std::lock_guard<std::mutex> lock(g_effectsMutex);
-                        original = g_originalEffects[effect];
-                    }
-
-                    // Apply magnitude scaling (inverted for SlowTime)
-                    bool isSlowTime = effect->baseEffect->HasArchetype(RE::EffectArchetypes::ArchetypeID::kSlowTime);
-                    if (isSlowTime) {
-                        float slowedMagnitude = original.originalMagnitude / magnitudeMultiplier;
-                        constexpr float MIN_TIME_SCALE = 0.05f;
-                        effect->effectItem.magnitude = std::max(slowedMagnitude, MIN_TIME_SCALE);
-                    } else {
-                        effect->effectItem.magnitude = original.originalMagnitude * magnitudeMultiplier;
-                    }
-
-                    effectsModified++;
-
-                    // Apply projectile scaling
-                    auto* projectile = effect->baseEffect->data.projectileBase;
-                    if (projectile) {
-                        {
-                            std::lock_guard<std::mutex> lock(g_projectilesMutex);
-                            if (g_originalProjectiles.find(projectile) == g_originalProjectiles.end()) {
-                                g_originalProjectiles[projectile] = {
-                                    projectile->data.speed,
-                                    projectile->data.range
-                                };
-                            }
-                        }
-
-                        ProjectileData origProj;
-                        {
-                            std::lock_guard<std::mutex> lock(g_projectilesMutex);
-                            origProj = g_originalProjectiles[projectile];
-                        }
-                        projectile->data.speed = origProj.originalSpeed * distanceMultiplier;
-                        projectile->data.range = origProj.originalRange * distanceMultiplier;
-
-                        if (config->bEnableDebugLogging) {
-                            SKSE::log::info("  Effect #{}: mag {} -> {}, proj speed {} -> {}, range {} -> {} {}",
-                                i + 1,
-                                original.originalMagnitude, effect->effectItem.magnitude,
-                                origProj.originalSpeed, projectile->data.speed,
-                                origProj.originalRange, projectile->data.range,
-                                isSlowTime ? "(SlowTime - inverted)" : "");
-                        }
-                    } else {
-                        if (config->bEnableDebugLogging) {
-                            SKSE::log::info("  Effect #{}: mag {} -> {} (no projectile){}",
-                                i + 1,
-                                original.originalMagnitude, effect->effectItem.magnitude,
-                                isSlowTime ? " (SlowTime - inverted)" : "");
-                        }
-                    }
-                }
+    // Debug only: in the synchronous trace mode every record is a log line flushed on the game thread
+    if (!Config::GetSingleton()->bEnableDebugLogging ||
+        _eventsSinceStats.fetch_add(1, std::memory_order_relaxed) % LOG_INTERVAL != LOG_INTERVAL - 1) {
+        return;
+    }
+
+    auto stats = ScalingPlan::GetSingleton()->GetCacheStats();
+    TraceLog::GetSingleton()->WriteUInt(Trace::Event::kCacheStats, 0, static_cast<std::uint32_t>(stats.applyHits),
+                                        static_cast<std::uint32_t>(stats.applyMisses),
+                                        static_cast<std::uint32_t>(stats.restoreHits),
+                                        static_cast<std::uint32_t>(stats.restoreMisses));
+}
+
+struct VoiceSpellCastHook {
+    static void thunk(RE::ActorMagicCaster* a_this, bool a_doCast, std::uint32_t a_arg2, RE::MagicItem* a_spell) {
+        // Seen and filtered count plugin calls as the sink path does, so the two modes compare in the metrics
+        SP_METRICS_ADD(kEventsSeen, 1);
+        if (!a_doCast || !a_spell || a_spell->GetSpellType() != RE::MagicSystem::SpellType::kVoicePower) {
+            SP_METRICS_ADD(kEventsFiltered, 1);
+        } else {
+            auto* shout = ScalingPlan::GetSingleton()->FindShoutBySpell(a_spell);
+            auto* actor = a_this->GetCasterAsActor();
+            if (shout && actor) {
+                ShoutHandler::GetSingleton()->OnShoutCast(actor, shout, true);
             }
         }
+        func(a_this, a_doCast, a_arg2, a_spell);
     }
+    static inline REL::Relocation<decltype(thunk)> func;
+};
 
-    if (config->bEnableDebugLogging) {
-        SKSE::log::info("  Total effects modified: {}", effectsModified);
-    }
+void ShoutHandler::InstallHook() {
+    REL::Relocation<std::uintptr_t> vtbl{ RE::VTABLE_ActorMagicCaster[0] };
+    VoiceSpellCastHook::func = vtbl.write_vfunc(0x9, VoiceSpellCastHook::thunk);
+    SKSE::log::info("Voice spell cast hook installed");
 }
 
 RE::BSEventNotifyControl ShoutHandler::ProcessEvent(const SKSE::ActionEvent* a_event, RE::BSTEventSource<SKSE::ActionEvent>*) {
+    SP_METRICS_ADD(kEventsSeen, 1);
+
     if (!a_event) {
         return RE::BSEventNotifyControl::kContinue;
     }
 
     if (a_event->type != SKSE::ActionEvent::Type::kVoiceCast &&
         a_event->type != SKSE::ActionEvent::Type::kVoiceFire) {
+        SP_METRICS_ADD(kEventsFiltered, 1);
         return RE::BSEventNotifyControl::kContinue;
     }
 
+    auto* shout = a_event->sourceForm ? a_event->sourceForm->As<RE::TESShout>() : nullptr;
+    if (!a_event->actor || !shout) {
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    OnShoutCast(a_event->actor, shout, a_event->type == SKSE::ActionEvent::Type::kVoiceFire);
+
+    return RE::BSEventNotifyControl::kContinue;
+}
+
+void ShoutHandler::OnShoutCast(RE::Actor* actor, RE::TESShout* shout, bool fired) {
+    SP_METRICS_SCOPE(kProcessEvent);
+
+    // One snapshot for the whole cast, so a reload cannot mix old and new settings
     auto* config = Config::GetSingleton();
+    Metrics::MaybeDumpPeriodic(static_cast<std::uint32_t>(config->iMetricsDumpInterval));
+
     auto* player = RE::PlayerCharacter::GetSingleton();
+    if (!player) {
+        return;
+    }
 
-    if (!player || !a_event->actor) {
-        return RE::BSEventNotifyControl::kContinue;
+    bool isPlayer = actor->formID == player->formID;
+    if (isPlayer) {
+        SP_METRICS_ADD(kPlayerCasts, 1);
+    } else {
+        SP_METRICS_ADD(kNPCCasts, 1);
     }
 
-    auto* shout = a_event->sourceForm ? a_event->sourceForm->As<RE::TESShout>() : nullptr;
-    if (!shout) {
-        return RE::BSEventNotifyControl::kContinue;
+    auto* trace = TraceLog::GetSingleton();
+    if (trace->IsCapturing()) {
+        // Souls are read here too, so the capture has them even for events that stop before scaling
+        auto souls = isPlayer ? ReadSouls(player, config) : Souls{};
+        trace->WriteCast(actor->GetFormID(), shout->GetFormID(), isPlayer, fired,
+                         static_cast<std::uint32_t>(souls.unspent), static_cast<std::uint32_t>(souls.spent));
     }
 
-    // Store original shout data on first encounter
-    StoreOriginalShoutData(shout);
+    // Per-cast mode never touches the shared forms: NPCs have nothing to restore, and the player's cast is scaled once
+    // it has fired.
+    if (config->bPerCastScaling && (!isPlayer || !fired)) {
+        return;
+    }
 
-    // If an NPC is casting, restore original values to prevent NPCs from using buffed shouts
-    if (a_event->actor->formID != player->formID) {
-        RestoreNPCShoutValues(shout);
-        return RE::BSEventNotifyControl::kContinue;
+    // NPCs use vanilla values, so they never cast the player's buffed shouts, unless they progress on their own
+    if (!isPlayer) {
+        int actorSouls = config->bNPCProgression ? ReadActorSouls(actor, config) : -1;
+        if (actorSouls < 0) {
+            RestoreNPCShoutValues(shout);
+        } else {
+            ApplyNPCShoutScaling(actor, shout, actorSouls, config);
+        }
+        return;
     }
 
     // Calculate total souls for scaling
-    int unspentSouls = static_cast<int>(player->AsActorValueOwner()->GetActorValue(RE::ActorValue::kDragonSouls));
-    int spentSouls = config->bCountSpentSouls ? CountUnlockedShoutWords(player) : 0;
-    int totalSouls = unspentSouls + spentSouls;
+    auto souls = ReadSouls(player, config);
+    int totalSouls = souls.unspent + souls.spent;
 
     if (config->bEnableDebugLogging) {
-        SKSE::log::info("  Unspent Souls: {}", unspentSouls);
-        SKSE::log::info("  Spent Souls (unlocked words): {}", spentSouls);
-        SKSE::log::info("  Total Souls: {}", totalSouls);
+        trace->WriteUInt(Trace::Event::kSouls, 0, static_cast<std::uint32_t>(souls.unspent),
+                         static_cast<std::uint32_t>(souls.spent), static_cast<std::uint32_t>(totalSouls));
     }
 
-    // Apply scaling to player's shout
-    ApplyShoutScaling(shout, totalSouls);
+    if (config->bPerCastScaling) {
+        PerCastScaler::GetSingleton()->OnPlayerShoutFired(player, GetMultipliers(config, shout, totalSouls));
+        return;
+    }
 
-    return RE::BSEventNotifyControl::kContinue;
+    // Apply scaling to player's shout
+    ApplyShoutScaling(shout, totalSouls, config);
 }
 
-float ShoutHandler::CalculateDistanceMultiplier(int dragonSouls) {
-    auto* config = Config::GetSingleton();
-
-    int clampedSouls = std::min(dragonSouls, config->iMaxDragonSouls);
-
-    float multiplier = config->fMinDistanceMultiplier + (static_cast<float>(clampedSouls) * config->fDistanceMultiplier);
-
-    return multiplier;
+ShoutHandler::Souls ShoutHandler::ReadSouls(RE::PlayerCharacter* player, const Config* config) {
+    int unspentSouls = static_cast<int>(player->AsActorValueOwner()->GetActorValue(RE::ActorValue::kDragonSouls));
+    int spentSouls = config->bCountSpentSouls ? CountUnlockedShoutWords(player) : 0;
+    return { unspentSouls, spentSouls };
 }
 
-float ShoutHandler::CalculateMagnitudeMultiplier(int dragonSouls) {
-    auto* config = Config::GetSingleton();
-
-    int clampedSouls = std::min(dragonSouls, config->iMaxDragonSouls);
+int ShoutHandler::ReadActorSouls(RE::Actor* actor, const Config* config) {
+    auto progression = _actorCache.Get(actor->GetFormID(), config->generation,
+                                       [&]() { return ResolveProgression(actor, config); });
+
+    using Source = Core::ActorProgression::Source;
+    switch (progression.source) {
+        case Source::kFixed:
+            return progression.souls;
+        case Source::kFollower:
+            if (!actor->IsPlayerTeammate()) {
+                return -1;
+            }
+            [[fallthrough]];
+        case Source::kLevel: {
+            auto souls = static_cast<int>(static_cast<float>(actor->GetLevel()) * config->fNPCSoulsPerLevel);
+            return std::clamp(souls, 0, config->iMaxDragonSouls);
+        }
+        case Source::kNone:
+            break;
+    }
+    return -1;
+}
 
-    float multiplier = config->fMinMagnitudeMultiplier + (static_cast<float>(clampedSouls) * config->fMagnitudeMultiplier);
+// Rules name an actor either by its reference or by its base NPC; the reference wins
+Core::ActorProgression ShoutHandler::ResolveProgression(RE::Actor* actor, const Config* config) {
+    using Source = Core::ActorProgression::Source;
 
-    return multiplier;
+    const auto* souls = config->actorSouls.Find(actor->GetFormID());
+    if (!souls) {
+        auto* base = actor->GetActorBase();
+        souls = base ? config->actorSouls.Find(base->GetFormID()) : nullptr;
+    }
+    if (souls) {
+        if (*souls == RulesFile::ACTOR_SOULS_FROM_LEVEL) {
+            return { Source::kLevel, 0 };
+        }
+        return { Source::kFixed, static_cast<std::uint16_t>(*souls) };
+    }
+    return { config->bFollowerProgression ? Source::kFollower : Source::kNone, 0 };
 }
 
-float ShoutHandler::CalculateCooldownMultiplier(int dragonSouls) {
-    auto* config = Config::GetSingleton();
+ScalingPlan::Multipliers ShoutHandler::GetMultipliers(const Config* config, const RE::TESShout* shout,
+                                                      int totalSouls) {
+    ScalingPlan::Multipliers multipliers{ CalculateDistanceMultiplier(config, totalSouls),
+                                          CalculateMagnitudeMultiplier(config, totalSouls),
+                                          CalculateCooldownMultiplier(config, totalSouls) };
 
-    int clampedSouls = std::min(dragonSouls, config->iMaxDragonSouls);
+    if (const auto* rule = config->rules.Find(shout->GetFormID())) {
+        multipliers = config->rules.Apply(*rule, multipliers, totalSouls);
+    }
+    return multipliers;
+}
 
-    // Cooldown reduction: higher souls = lower cooldown
-    // Formula: 1.0 - (souls * reduction) = cooldown multiplier
-    // Example: 1.0 - (50 * 0.01) = 0.5 (50% of original cooldown)
-    float multiplier = 1.0f - (static_cast<float>(clampedSouls) * config->fCooldownReduction);
+float ShoutHandler::CalculateDistanceMultiplier(const Config* config, int dragonSouls) {
+    return config->distanceTable.Lookup(dragonSouls);
+}
 
-    // Clamp to minimum cooldown multiplier
-    multiplier = std::max(multiplier, config->fMinCooldownMultiplier);
+float ShoutHandler::CalculateMagnitudeMultiplier(const Config* config, int dragonSouls) {
+    return config->magnitudeTable.Lookup(dragonSouls);
+}
 
-    return multiplier;
+float ShoutHandler::CalculateCooldownMultiplier(const Config* config, int dragonSouls) {
+    return config->cooldownTable.Lookup(dragonSouls);
 }
 
 int ShoutHandler::CountUnlockedShoutWords(RE::PlayerCharacter* player) {
-    if (!player) {
-        return 0;
-    }
-
-    int unlockedWords = 0;
+    SP_METRICS_SCOPE(kCountUnlockedShoutWords);
 
-    auto* dataHandler = RE::TESDataHandler::GetSingleton();
-    if (!dataHandler) {
-        return 0;
-    }
-
-    for (auto& shout : dataHandler->GetFormArray<RE::TESShout>()) {
-        if (shout && player->HasShout(shout)) {
-            for (int i = 0; i < 3; i++) {
-                auto* word = shout->variations[i].word;
-                if (word && word->GetKnown()) {
-                    unlockedWords++;
-                }
-            }
-        }
-    }
-
-    return unlockedWords;
+    return SoulCounter::GetSingleton()->GetSpentSouls(player);
 }
-
-
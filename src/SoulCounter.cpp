@@ -0,0 +1,103 @@
+#include "SoulCounter.h"
+#include "BatchScaler.h"
+#include "Config.h"
+#include "GameForms.h"
+#include "TraceLog.h"
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+SoulCounter* SoulCounter::GetSingleton() {
+    static SoulCounter singleton;
+    return &singleton;
+}
+
+void SoulCounter::Register() {
+    if (auto* source = RE::WordLearned::GetEventSource()) {
+        source->AddEventSink<RE::WordLearned::Event>(this);
+    } else {
+        SKSE::log::warn("Failed to get WordLearned event source, spent souls will be recounted on every shout");
+    }
+
+    if (auto* source = RE::WordUnlocked::GetEventSource()) {
+        source->AddEventSink<RE::WordUnlocked::Event>(this);
+    } else {
+        SKSE::log::warn("Failed to get WordUnlocked event source, spent souls will be recounted on every shout");
+    }
+
+    SKSE::log::info("Soul counter registered for word events");
+}
+
+void SoulCounter::Reseed() {
+    _cache.MarkDirty();
+    GetSpentSouls(RE::PlayerCharacter::GetSingleton());
+}
+
+std::uint64_t SoulCounter::HashPlayerShouts(RE::PlayerCharacter* player) {
+    auto* base = player->GetActorBase();
+    auto* effects = base ? base->actorEffects : nullptr;
+    if (!effects || !effects->shouts) {
+        return 0;
+    }
+
+    return Core::HashShoutList(effects->shouts, effects->numShouts);
+}
+
+int SoulCounter::CountPlayerShouts(RE::PlayerCharacter* player) {
+    auto* base = player->GetActorBase();
+    auto* effects = base ? base->actorEffects : nullptr;
+    if (!effects || !effects->shouts) {
+        return 0;
+    }
+
+    return Core::CountKnownWords<GameForms>(effects->shouts, effects->numShouts);
+}
+
+int SoulCounter::CountFullScan(RE::PlayerCharacter* player) {
+    auto* dataHandler = RE::TESDataHandler::GetSingleton();
+    if (!player || !dataHandler) {
+        return 0;
+    }
+
+    int words = 0;
+    for (auto& shout : dataHandler->GetFormArray<RE::TESShout>()) {
+        if (shout && player->HasShout(shout)) {
+            words += Core::CountKnownWords<GameForms>(shout);
+        }
+    }
+    return words;
+}
+
+int SoulCounter::GetSpentSouls(RE::PlayerCharacter* player) {
+    if (!player) {
+        return 0;
+    }
+
+    // The full-scan cross-check runs only when the cache recounts (a word learned, the shout list changed), so debug
+    // logging does not bring the scan of every TESShout back onto the cast path
+    return _cache.Get(HashPlayerShouts(player), [player]() {
+        int spentSouls = CountPlayerShouts(player);
+        if (Config::GetSingleton()->bEnableDebugLogging) {
+            int fullScan = CountFullScan(player);
+            if (fullScan != spentSouls) {
+                TraceLog::GetSingleton()->WriteUInt(Trace::Event::kSoulDrift, 0,
+                                                    static_cast<std::uint32_t>(spentSouls),
+                                                    static_cast<std::uint32_t>(fullScan));
+            }
+        }
+        return spentSouls;
+    });
+}
+
+RE::BSEventNotifyControl SoulCounter::ProcessEvent(const RE::WordLearned::Event*,
+                                                   RE::BSTEventSource<RE::WordLearned::Event>*) {
+    _cache.MarkDirty();
+    BatchScaler::GetSingleton()->Schedule();
+    return RE::BSEventNotifyControl::kContinue;
+}
+
+RE::BSEventNotifyControl SoulCounter::ProcessEvent(const RE::WordUnlocked::Event*,
+                                                   RE::BSTEventSource<RE::WordUnlocked::Event>*) {
+    _cache.MarkDirty();
+    BatchScaler::GetSingleton()->Schedule();
+    return RE::BSEventNotifyControl::kContinue;
+}
@@ -0,0 +1,230 @@
+#include "TraceLog.h"
+#include <SKSE/SKSE.h>
+#include <fstream>
+#include <vector>
+
+TraceLog* TraceLog::GetSingleton() {
+    static TraceLog singleton;
+    return &singleton;
+}
+
+TraceLog::TraceLog() : _slots(CAPACITY) {
+    for (std::size_t i = 0; i < CAPACITY; i++) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+TraceLog::~TraceLog() {
+    // Joining from a static destructor can deadlock on the loader lock during process exit; the process is going
+    // away anyway, so just let the writer go.
+    if (_writer.joinable()) {
+        _writer.request_stop();
+        _writer.detach();
+    }
+}
+
+void TraceLog::Start(Mode mode, const std::filesystem::path& logDirectory, bool capture) {
+    Stop();
+
+    _mode.store(mode, std::memory_order_release);
+    if (mode == Mode::kSynchronous && !capture) {
+        return;
+    }
+
+    auto pluginName = SKSE::PluginDeclaration::GetSingleton()->GetName();
+    auto binaryPath = mode == Mode::kAsyncBinary ? logDirectory / std::format("{}.trace", pluginName)
+                                                 : std::filesystem::path{};
+    auto capturePath = capture ? logDirectory / std::format("{}.capture", pluginName) : std::filesystem::path{};
+
+    _capturing.store(capture, std::memory_order_release);
+    _writer = std::jthread(
+        [this, binaryPath, capturePath](std::stop_token stop) { Run(stop, binaryPath, capturePath); });
+
+    if (mode == Mode::kAsyncBinary) {
+        SKSE::log::info("Asynchronous binary trace enabled: {}", binaryPath.string());
+    } else if (mode == Mode::kAsyncText) {
+        SKSE::log::info("Asynchronous debug logging enabled");
+    }
+    if (capture) {
+        SKSE::log::info("Capturing shout events to {}", capturePath.string());
+    }
+}
+
+void TraceLog::Stop() {
+    if (_writer.joinable()) {
+        _writer.request_stop();
+        _writer.join();
+    }
+    _mode.store(Mode::kSynchronous, std::memory_order_release);
+    _capturing.store(false, std::memory_order_release);
+}
+
+void TraceLog::Write(Trace::Event event, std::uint32_t form, float f0, float f1, float f2, float f3) {
+    Trace::Record record{ Now(), event, 0, form, {} };
+    record.f[0] = f0;
+    record.f[1] = f1;
+    record.f[2] = f2;
+    record.f[3] = f3;
+    Submit(record);
+}
+
+void TraceLog::WriteUInt(Trace::Event event, std::uint32_t form, std::uint32_t u0, std::uint32_t u1,
+                         std::uint32_t u2, std::uint32_t u3) {
+    Trace::Record record{ Now(), event, 0, form, {} };
+    record.u[0] = u0;
+    record.u[1] = u1;
+    record.u[2] = u2;
+    record.u[3] = u3;
+    Submit(record);
+}
+
+void TraceLog::WriteCast(std::uint32_t actor, std::uint32_t shout, bool player, bool fired, std::uint32_t unspentSouls,
+                         std::uint32_t spentSouls) {
+    if (!IsCapturing()) {
+        return;
+    }
+
+    Trace::Record record{ Now(), Trace::Event::kCast, 0, shout, {} };
+    record.u[0] = actor;
+    record.u[1] = (player ? Trace::CAST_PLAYER : 0u) | (fired ? Trace::CAST_FIRED : 0u);
+    record.u[2] = unspentSouls;
+    record.u[3] = spentSouls;
+    if (!TryPush(record)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TraceLog::Submit(const Trace::Record& record) {
+    if (_mode.load(std::memory_order_acquire) == Mode::kSynchronous) {
+        SKSE::log::info("{}", Trace::Format(record).View());
+        return;
+    }
+
+    if (!TryPush(record)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Bounded multi-producer ring (Vyukov): each slot's sequence tells producers whether it is free for their ticket
+// and the consumer whether it has been filled.
+bool TraceLog::TryPush(const Trace::Record& record) {
+    auto position = _head.load(std::memory_order_relaxed);
+    for (;;) {
+        auto& slot = _slots[position & (CAPACITY - 1)];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::int64_t>(sequence) - static_cast<std::int64_t>(position);
+
+        if (diff == 0) {
+            if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            position = _head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TraceLog::TryPop(Trace::Record& record) {
+    auto& slot = _slots[_tail & (CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != _tail + 1) {
+        return false;
+    }
+
+    record = slot.record;
+    slot.sequence.store(_tail + CAPACITY, std::memory_order_release);
+    _tail++;
+    return true;
+}
+
+void TraceLog::Run(std::stop_token stop, std::filesystem::path binaryPath, std::filesystem::path capturePath) {
+    auto open = [](std::ofstream& stream, const std::filesystem::path& path) {
+        if (path.empty()) {
+            return;
+        }
+        stream.open(path, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            SKSE::log::error("Failed to open trace file {}", path.string());
+            return;
+        }
+        Trace::FileHeader header;
+        header.startTimestamp = Now();
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    };
+
+    std::ofstream binary;
+    std::ofstream capture;
+    open(binary, binaryPath);
+    open(capture, capturePath);
+
+    std::vector<Trace::Record> batch;
+    batch.reserve(BATCH_SIZE);
+    std::uint64_t reportedDropped = 0;
+
+    auto flush = [&]() {
+        auto dropped = _dropped.load(std::memory_order_relaxed);
+        if (dropped != reportedDropped) {
+            Trace::Record record{ Now(), Trace::Event::kDropped, 0, 0, {} };
+            record.u[0] = static_cast<std::uint32_t>(dropped - reportedDropped);
+            batch.push_back(record);
+            reportedDropped = dropped;
+        }
+
+        if (batch.empty()) {
+            return;
+        }
+
+        // Casts go to the capture file only; a drop marker goes to both so the replayer knows the capture has gaps
+        if (capture.is_open()) {
+            for (const auto& record : batch) {
+                if (record.event == Trace::Event::kCast || record.event == Trace::Event::kDropped) {
+                    capture.write(reinterpret_cast<const char*>(&record), sizeof(record));
+                }
+            }
+            capture.flush();
+        }
+        std::erase_if(batch, [](const Trace::Record& record) { return record.event == Trace::Event::kCast; });
+        if (batch.empty()) {
+            return;
+        }
+
+        if (binary.is_open()) {
+            binary.write(reinterpret_cast<const char*>(batch.data()),
+                         static_cast<std::streamsize>(batch.size() * sizeof(Trace::Record)));
+            binary.flush();
+        } else {
+            for (const auto& record : batch) {
+                SKSE::log::info("{}", Trace::Format(record).View());
+            }
+            spdlog::default_logger()->flush();
+        }
+        batch.clear();
+    };
+
+    while (!stop.stop_requested()) {
+        Trace::Record record;
+        while (batch.size() < BATCH_SIZE && TryPop(record)) {
+            batch.push_back(record);
+        }
+
+        if (batch.empty()) {
+            flush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        flush();
+    }
+
+    // Drain what is left so nothing logged before shutdown is lost
+    Trace::Record record;
+    while (TryPop(record)) {
+        batch.push_back(record);
+        if (batch.size() == BATCH_SIZE) {
+            flush();
+        }
+    }
+    flush();
+}
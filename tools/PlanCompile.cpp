@@ -0,0 +1,133 @@
+// Compiles the scaling plan from plugin files on disk and writes the plan cache the plugin loads at kDataLoaded
+// (bUsePlanCache), with a report of projectiles that scaling shouts would also change for other spells.
+//
+//   ShoutProgressionPlanCompile <Data folder> <plugins.txt> [output]
+//
+// The output defaults to <Data folder>/SKSE/Plugins/ShoutProgression.plancache. The cache is keyed by the name, size
+// and write time of every plugin, so it is used in game only while the load order matches the one read here.
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/PlanCache.h"
+#include "core/PluginReader.h"
+#include "core/ShoutPlan.h"
+
+namespace {
+    using Plan = Core::Plan<Esp::Forms>;
+
+    constexpr std::size_t REPORT_LIMIT = 25;  // entries per report section
+    constexpr std::size_t USER_LIMIT = 6;     // shouts or spells listed per entry
+
+    double Milliseconds(std::chrono::steady_clock::duration elapsed) {
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    template <class Form>
+    void PrintForm(const Form* form) {
+        std::printf(" %08X", form->formID);
+        if (!form->editorID.empty()) {
+            std::printf(" (%.*s)", static_cast<int>(form->editorID.size()), form->editorID.data());
+        }
+    }
+
+    template <class Forms>
+    void PrintList(const char* label, const Forms& forms) {
+        std::printf("    %s:", label);
+        for (std::size_t i = 0; i < forms.size() && i < USER_LIMIT; i++) {
+            PrintForm(forms[i]);
+        }
+        if (forms.size() > USER_LIMIT) {
+            std::printf(" and %zu more", forms.size() - USER_LIMIT);
+        }
+        std::printf("\n");
+    }
+
+    void Report(const Esp::LoadOrder& loadOrder) {
+        auto projectiles = loadOrder.FindSharedProjectiles();
+        std::printf("\nProjectiles scaled by shouts and also fired by other spells: %zu\n", projectiles.size());
+        for (std::size_t i = 0; i < projectiles.size() && i < REPORT_LIMIT; i++) {
+            const auto& entry = projectiles[i];
+            std::printf("  PROJ");
+            PrintForm(entry.projectile);
+            std::printf(": speed %g, range %g\n", entry.projectile->data.speed, entry.projectile->data.range);
+            PrintList("shouts", entry.shouts);
+            PrintList("spells", entry.spells);
+        }
+
+        auto spells = loadOrder.FindSharedSpells();
+        std::printf("\nSpells used by more than one shout: %zu\n", spells.size());
+        for (std::size_t i = 0; i < spells.size() && i < REPORT_LIMIT; i++) {
+            std::printf("  SPEL");
+            PrintForm(spells[i].spell);
+            std::printf("\n");
+            PrintList("shouts", spells[i].shouts);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <Data folder> <plugins.txt> [output]\n", argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path data = argv[1];
+    auto output = argc > 3 ? std::filesystem::path(argv[3]) : data / "SKSE" / "Plugins" / "ShoutProgression.plancache";
+
+    auto plugins = Esp::ReadPluginsTxt(argv[2], data);
+    if (plugins.empty()) {
+        std::fprintf(stderr, "no plugins to read from %s\n", argv[2]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Esp::LoadOrder loadOrder;
+    std::string error;
+    if (!loadOrder.Read(data, plugins, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    auto read = std::chrono::steady_clock::now();
+
+    Plan plan;
+    Core::PlanCacheData cache;
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+    const auto* snapshot = plan.Build(loadOrder.shouts, &cache, threads);
+    auto hash = Core::HashLoadOrder(data, loadOrder.GetCanonicalPlugins(), loadOrder.shouts.size());
+    auto compiled = std::chrono::steady_clock::now();
+
+    std::error_code ignored;
+    std::filesystem::create_directories(output.parent_path(), ignored);
+    if (!Core::WritePlanCache(output, hash, cache)) {
+        std::fprintf(stderr, "cannot write %s\n", output.string().c_str());
+        return 1;
+    }
+
+    // Load it back the way the plugin does, so a cache that would be rejected in game is caught here
+    Core::PlanCacheView view;
+    Plan check;
+    if (!view.Open(output, hash, error) || !check.BuildFromCache(view, error)) {
+        std::fprintf(stderr, "written cache does not load: %s\n", error.c_str());
+        return 1;
+    }
+    auto verified = std::chrono::steady_clock::now();
+
+    const auto& stats = loadOrder.GetStats();
+    std::printf("%zu plugins, %.1f MB mapped, %.1f MB of SHOU/SPEL/MGEF/PROJ groups walked, %u groups skipped\n",
+                loadOrder.GetPlugins().size(), static_cast<double>(stats.bytesMapped) / 1e6,
+                static_cast<double>(stats.bytesWalked) / 1e6, stats.groupsSkipped);
+    std::printf("%u records (%u overridden, %u compressed), %u unresolved references\n", stats.records,
+                stats.overrides, stats.compressed, stats.unresolved);
+    std::printf("Plan: %zu shouts, %zu records -> %s\n", snapshot->entries.size(), snapshot->records.size(),
+                output.string().c_str());
+    std::printf("Read %.1f ms, compile %.1f ms, write and verify %.1f ms\n", Milliseconds(read - start),
+                Milliseconds(compiled - read), Milliseconds(verified - compiled));
+
+    Report(loadOrder);
+    return 0;
+}
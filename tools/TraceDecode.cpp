@@ -0,0 +1,58 @@
+// Decodes the binary trace written with iDebugLogMode = 2 into the same text the synchronous log would contain.
+//
+//   ShoutProgressionTraceDecode ShoutProgression.trace [output.log]
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "TraceFormat.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <trace file> [output file]\n";
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    Trace::FileHeader header;
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "SPTR", 4) != 0) {
+        std::cerr << argv[1] << " is not a ShoutProgression trace\n";
+        return 1;
+    }
+    if (header.version != 1 || header.recordSize != sizeof(Trace::Record)) {
+        std::cerr << "unsupported trace version " << header.version << " (record size " << header.recordSize << ")\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc > 2) {
+        file.open(argv[2]);
+        if (!file) {
+            std::cerr << "cannot open " << argv[2] << "\n";
+            return 1;
+        }
+    }
+    std::ostream& output = file.is_open() ? file : std::cout;
+
+    std::uint64_t count = 0;
+    Trace::Record record;
+    while (input.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        double seconds = static_cast<double>(record.timestamp - header.startTimestamp) / 1e9;
+        output << Trace::Printf("[%12.6f] ", seconds).View() << Trace::Format(record).View() << "\n";
+        count++;
+    }
+
+    if (input.gcount() != 0) {
+        std::cerr << "warning: trailing partial record ignored\n";
+    }
+    std::cerr << count << " records decoded\n";
+    return 0;
+}